@@ -0,0 +1,131 @@
+/**
+ * @file decision_record.hpp
+ * @brief Registro de uma decisão de rolar ou parar, gravado pelo jogo e lido pelo `zanalyze`
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Cada decisão tomada em `START`/`SHOW_SCOREBOARD` vira uma linha de texto com campos
+ * separados por tabulação:
+ *
+ *     nome  saco(g,y,r)  tail  hand  tiros  guardados  melhor_adversário  roll|hold
+ *
+ * Os dados de `tail` e `hand` usam g (verde/fraco), y (amarelo/resistente) e r
+ * (vermelho/forte), na ordem dos sacos, e "-" quando vazios (como no `zengine`).
+ */
+
+#ifndef DECISION_RECORD_HPP
+#define DECISION_RECORD_HPP
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "turn_model.hpp"
+
+/**
+ * @struct DecisionRecord
+ * @brief Uma decisão de um jogador
+ *
+ * @var DecisionRecord::player Nome do jogador
+ * @var DecisionRecord::turn Estado do turno no momento da decisão
+ * @var DecisionRecord::banked Cérebros já guardados pelo jogador
+ * @var DecisionRecord::best_opponent Maior pontuação entre os outros jogadores
+ * @var DecisionRecord::hold Decisão tomada (true = parar)
+ */
+struct DecisionRecord {
+  std::string player;
+  TurnState turn;
+  size_t banked{ 0 };
+  size_t best_opponent{ 0 };
+  bool hold{ false };
+
+  /// @brief Linha do registro (sem o '\n')
+  std::string str() const {
+    std::ostringstream oss;
+    oss << player << '\t' << int(turn.pool[WEAK]) << ',' << int(turn.pool[TOUGH]) << ','
+        << int(turn.pool[STRONG]) << '\t' << dice(turn.tail) << '\t' << dice(turn.hand) << '\t'
+        << int(turn.shots) << '\t' << banked << '\t' << best_opponent << '\t'
+        << (hold ? "hold" : "roll");
+    return oss.str();
+  }
+
+  /**
+   * @brief Lê uma linha gravada por `str()`
+   * @return false se a linha estiver malformada
+   */
+  bool parse(const std::string& line) {
+    std::string fields[8];
+    size_t n = 0;
+    for (size_t start = 0; n < 8; ++n) {
+      auto end = line.find('\t', start);
+      fields[n] = line.substr(start, end - start);
+      if (end == std::string::npos) {
+        ++n;
+        break;
+      }
+      start = end + 1;
+    }
+    if (n != 8 or fields[0].empty() or (fields[7] != "roll" and fields[7] != "hold")) {
+      return false;
+    }
+
+    DecisionRecord r;
+    r.player = fields[0];
+    r.hold = fields[7] == "hold";
+    unsigned pool[3], shots;
+    auto c1 = fields[1].find(','), c2 = fields[1].find(',', c1 + 1);
+    if (c1 == std::string::npos or c2 == std::string::npos
+        or not number(fields[1].substr(0, c1), pool[0])
+        or not number(fields[1].substr(c1 + 1, c2 - c1 - 1), pool[1])
+        or not number(fields[1].substr(c2 + 1), pool[2]) or not number(fields[4], shots)
+        or not number(fields[5], r.banked) or not number(fields[6], r.best_opponent)
+        or not read_dice(fields[2], r.turn.tail) or not read_dice(fields[3], r.turn.hand)
+        or shots > 255
+        or pool[0] + pool[1] + pool[2] + r.turn.tail.size() > DieSeq::capacity) {
+      return false;
+    }
+    for (size_t t = 0; t < 3; ++t) {
+      r.turn.pool[t] = static_cast<uint8_t>(pool[t]);
+    }
+    r.turn.shots = static_cast<uint8_t>(shots);
+    *this = std::move(r);
+    return true;
+  }
+
+private:
+  static std::string dice(const DieSeq& seq) {
+    std::string s;
+    for (auto t : seq) {
+      s += "gyr"[t % 3];
+    }
+    return s.empty() ? "-" : s;
+  }
+
+  static bool read_dice(const std::string& s, DieSeq& seq) {
+    seq.clear();
+    if (s == "-") {
+      return true;
+    }
+    if (s.empty() or s.size() > DieSeq::capacity) {
+      return false;
+    }
+    for (char c : s) {
+      if (c != 'g' and c != 'y' and c != 'r') {
+        return false;
+      }
+      seq += static_cast<uint8_t>(c == 'g' ? WEAK : c == 'y' ? TOUGH : STRONG);
+    }
+    return true;
+  }
+
+  template <typename T>
+  static bool number(const std::string& s, T& value) {
+    if (s.empty() or s.find_first_not_of("0123456789") != std::string::npos or s.size() > 9) {
+      return false;
+    }
+    value = static_cast<T>(std::stoul(s));
+    return true;
+  }
+};
+
+#endif  // DECISION_RECORD_HPP
@@ -12,8 +12,10 @@
 #define DICE_BAG_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <random>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -37,18 +39,38 @@ enum DieType {
   STRONG  ///< Dado vermelho (forte) - Maior chance de tiros
 };
 
+/**
+ * @brief Semeia um gerador com os 64 bits da semente (mesma regra em todo o projeto)
+ */
+inline void seed_engine(std::mt19937& engine, uint64_t seed) {
+  std::seed_seq seq{ uint32_t(seed), uint32_t(seed >> 32) };
+  engine.seed(seq);
+}
+
+/**
+ * @brief Gerador aleatório compartilhado do jogo
+ *
+ * Usado, nesta ordem de consumo, pelo sorteio do jogador inicial, pelo embaralhamento do
+ * saco e pelas rolagens. Começa semeado por `std::random_device`; com `seed_engine()` a
+ * partida inteira fica reproduzível.
+ */
+inline std::mt19937& dice_engine() {
+  static std::mt19937 engine{ std::random_device{}() };
+  return engine;
+}
+
 /**
  * @struct ZDie
  * @brief Representa um dado individual do jogo
  *
  * @var ZDie::type Tipo do dado (WEAK/TOUGH/STRONG)
  * @var ZDie::faces Sequência de faces configuráveis
- * @var ZDie::face Resultado atual da rolagem
+ * @var ZDie::face Resultado atual da rolagem (0 se o dado ainda não foi rolado)
  */
 struct ZDie {
   DieType type;
   std::string faces;
-  char face;
+  char face{ 0 };
 
   /**
    * @brief Constrói um novo dado
@@ -61,13 +83,14 @@ struct ZDie {
    * @brief Rola o dado e atualiza a face atual
    */
   void roll() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<int> distrib(0, faces.size() - 1);
-    face = faces[distrib(gen)];
+    face = faces[distrib(dice_engine())];
   }
 };
 
+/// @brief Configuração dos dados: tipo, quantidade e sequência de faces de cada tipo
+using DiceConfig = std::vector<std::tuple<DieType, size_t, std::string>>;
+
 /**
  * @class DiceBag
  * @brief Gerenciador de dados do jogo
@@ -88,7 +111,7 @@ private:
 
   /// @brief Embaralha os dados usando algoritmo Fisher-Yates
   void shuffle_dice() {
-    std::shuffle(dice.begin(), dice.end(), std::mt19937{ std::random_device{}() });
+    std::shuffle(dice.begin(), dice.end(), dice_engine());
   }
 
   std::vector<ZDie> dice;  ///< Vetor de dados ativos
@@ -107,7 +130,7 @@ public:
    * - 3 dados resistentes: 1🧠 2👣 3💥
    * - 4 dados fortes:   2🧠 2👣 2💥
    */
-  std::vector<std::tuple<DieType, size_t, std::string>> dice_and_faces{
+  DiceConfig dice_and_faces{
     { WEAK, 6, "bbbffs" },
     { TOUGH, 3, "bffsss" },
     { STRONG, 4, "bbffss" },
@@ -0,0 +1,285 @@
+/**
+ * @file frame_broadcast.hpp
+ * @brief Transmissão de quadros do jogo para espectadores via memória compartilhada
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo implementa um buffer circular de um produtor e múltiplos consumidores
+ * (SPMC) em memória compartilhada POSIX. Cada mesa publica seus quadros renderizados e
+ * eventos uma única vez; qualquer número de espectadores locais lê os quadros direto da
+ * região mapeada, sem cópias intermediárias.
+ *
+ * O produtor nunca espera pelos leitores: quando o anel dá a volta, os quadros mais antigos
+ * são sobrescritos. Cada slot é protegido por um contador de sequência (seqlock), então o
+ * leitor detecta quadros sobrescritos durante a leitura e se ressincroniza a partir do
+ * último quadro-chave.
+ */
+
+#ifndef FRAME_BROADCAST_HPP
+#define FRAME_BROADCAST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @enum FrameKind
+ * @brief Tipo de registro publicado no anel
+ */
+enum FrameKind : uint32_t {
+  FRAME,     ///< Quadro renderizado parcial (depende dos anteriores)
+  KEYFRAME,  ///< Quadro completo (inclui o placar global)
+  EVENT      ///< Evento do jogo (estado + jogador atual), sem texto
+};
+
+/**
+ * @struct FrameSlot
+ * @brief Slot de tamanho fixo do anel
+ *
+ * @var FrameSlot::seq Sequência do slot: ímpar durante a escrita, 2 * (n + 1) após publicar n
+ * @var FrameSlot::kind Tipo do registro (FrameKind)
+ * @var FrameSlot::size Tamanho do conteúdo em bytes
+ * @var FrameSlot::data Conteúdo do quadro (UTF-8) ou do evento
+ */
+struct FrameSlot {
+  static constexpr size_t capacity = 16 * 1024 - 16;
+
+  std::atomic<uint64_t> seq;
+  uint32_t kind;
+  uint32_t size;
+  char data[capacity];
+};
+
+/**
+ * @struct BroadcastHeader
+ * @brief Cabeçalho da região compartilhada
+ *
+ * @var BroadcastHeader::head Próxima sequência a ser escrita
+ * @var BroadcastHeader::keyframe Sequência + 1 do último quadro-chave (0 = nenhum)
+ * @var BroadcastHeader::closed Diferente de zero quando a mesa encerrou a transmissão
+ */
+struct BroadcastHeader {
+  static constexpr uint32_t magic_value = 0x5a444246;  // "ZDBF"
+  static constexpr uint32_t version_value = 1;
+  static constexpr uint32_t slots = 256;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> keyframe;
+  std::atomic<uint32_t> closed;
+  uint32_t padding[7];
+  FrameSlot ring[slots];
+};
+
+/// @brief Nome POSIX da região de memória compartilhada de um canal
+inline std::string broadcast_shm_name(const std::string& channel) { return "/zdice." + channel; }
+
+/**
+ * @class FrameBroadcaster
+ * @brief Lado produtor do anel: uma mesa publicando seus quadros
+ */
+class FrameBroadcaster {
+public:
+  /**
+   * @brief Cria (ou recria) o canal de transmissão
+   * @param channel Nome do canal (uma mesa por canal)
+   */
+  explicit FrameBroadcaster(const std::string& channel) : name{ broadcast_shm_name(channel) } {
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+      return;
+    }
+    if (ftruncate(fd, sizeof(BroadcastHeader)) == 0) {
+      void* p = mmap(nullptr, sizeof(BroadcastHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (p != MAP_FAILED) {
+        header = static_cast<BroadcastHeader*>(p);
+      }
+    }
+    close(fd);
+
+    if (header == nullptr) {
+      shm_unlink(name.c_str());
+      return;
+    }
+
+    header->magic = 0;
+    header->version = BroadcastHeader::version_value;
+    header->slot_count = BroadcastHeader::slots;
+    header->slot_size = sizeof(FrameSlot);
+    header->head.store(0, std::memory_order_relaxed);
+    header->keyframe.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    for (auto& slot : header->ring) {
+      slot.seq.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = BroadcastHeader::magic_value;
+  }
+
+  FrameBroadcaster(const FrameBroadcaster&) = delete;
+  FrameBroadcaster& operator=(const FrameBroadcaster&) = delete;
+
+  /// @brief Encerra a transmissão e remove o nome do canal (leitores mantêm o mapeamento)
+  ~FrameBroadcaster() {
+    if (header != nullptr) {
+      header->closed.store(1, std::memory_order_release);
+      munmap(header, sizeof(BroadcastHeader));
+      shm_unlink(name.c_str());
+    }
+  }
+
+  /// @brief Indica se o canal foi criado com sucesso
+  bool is_open() const { return header != nullptr; }
+
+  /**
+   * @brief Publica um registro no anel, sem nunca bloquear
+   * @param content Conteúdo (truncado em FrameSlot::capacity bytes)
+   * @param kind Tipo do registro
+   */
+  void publish(std::string_view content, FrameKind kind) {
+    if (header == nullptr) {
+      return;
+    }
+    auto n = header->head.load(std::memory_order_relaxed);
+    auto& slot = header->ring[n % BroadcastHeader::slots];
+    auto size = std::min(content.size(), FrameSlot::capacity);
+
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.kind = kind;
+    slot.size = static_cast<uint32_t>(size);
+    std::memcpy(slot.data, content.data(), size);
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+
+    if (kind == KEYFRAME) {
+      header->keyframe.store(n + 1, std::memory_order_release);
+    }
+    header->head.store(n + 1, std::memory_order_release);
+  }
+
+private:
+  std::string name;
+  BroadcastHeader* header{ nullptr };
+};
+
+/**
+ * @class FrameReader
+ * @brief Lado consumidor do anel: um espectador acompanhando uma mesa
+ *
+ * Os registros são entregues como views para a memória compartilhada. Após consumir o
+ * conteúdo, o chamador deve confirmar com `still_valid()`; se o produtor sobrescreveu o slot
+ * no meio da leitura o registro deve ser descartado.
+ */
+class FrameReader {
+public:
+  /// @brief Conecta-se, somente leitura, ao canal informado
+  explicit FrameReader(const std::string& channel) {
+    int fd = shm_open(broadcast_shm_name(channel).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 and static_cast<size_t>(st.st_size) >= sizeof(BroadcastHeader)) {
+      void* p = mmap(nullptr, sizeof(BroadcastHeader), PROT_READ, MAP_SHARED, fd, 0);
+      if (p != MAP_FAILED) {
+        header = static_cast<const BroadcastHeader*>(p);
+      }
+    }
+    close(fd);
+
+    if (header != nullptr
+        and (header->magic != BroadcastHeader::magic_value
+             or header->version != BroadcastHeader::version_value
+             or header->slot_size != sizeof(FrameSlot))) {
+      munmap(const_cast<BroadcastHeader*>(header), sizeof(BroadcastHeader));
+      header = nullptr;
+    }
+    if (header != nullptr) {
+      resync();
+    }
+  }
+
+  FrameReader(const FrameReader&) = delete;
+  FrameReader& operator=(const FrameReader&) = delete;
+
+  ~FrameReader() {
+    if (header != nullptr) {
+      munmap(const_cast<BroadcastHeader*>(header), sizeof(BroadcastHeader));
+    }
+  }
+
+  /// @brief Indica se o canal existe e tem formato compatível
+  bool is_open() const { return header != nullptr; }
+
+  /// @brief Indica se a mesa encerrou a transmissão e não há mais nada para ler
+  bool finished() const {
+    return header->closed.load(std::memory_order_acquire) != 0
+           and next == header->head.load(std::memory_order_acquire);
+  }
+
+  /// @brief Reposiciona o leitor no último quadro-chave (ou no registro mais recente)
+  void resync() {
+    auto head = header->head.load(std::memory_order_acquire);
+    auto key = header->keyframe.load(std::memory_order_acquire);
+    if (key != 0 and head - (key - 1) <= BroadcastHeader::slots) {
+      next = key - 1;
+    } else {
+      next = head == 0 ? 0 : head - 1;
+    }
+  }
+
+  /**
+   * @brief Obtém o próximo registro, sem copiá-lo
+   * @param kind Tipo do registro lido
+   * @param content View para o conteúdo dentro da memória compartilhada
+   * @return false se não há registro novo
+   */
+  bool next_frame(FrameKind& kind, std::string_view& content) {
+    auto head = header->head.load(std::memory_order_acquire);
+    if (next >= head) {
+      return false;
+    }
+    if (head - next > BroadcastHeader::slots) {
+      resync();
+    }
+    const auto& slot = header->ring[next % BroadcastHeader::slots];
+    if (slot.seq.load(std::memory_order_acquire) != 2 * next + 2) {
+      resync();
+      return false;
+    }
+    current = next++;
+    kind = static_cast<FrameKind>(slot.kind);
+    content = std::string_view{ slot.data, std::min<size_t>(slot.size, FrameSlot::capacity) };
+    return true;
+  }
+
+  /// @brief Confirma que o último registro não foi sobrescrito durante a leitura
+  bool still_valid() {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto& slot = header->ring[current % BroadcastHeader::slots];
+    if (slot.seq.load(std::memory_order_relaxed) == 2 * current + 2) {
+      return true;
+    }
+    resync();
+    return false;
+  }
+
+private:
+  const BroadcastHeader* header{ nullptr };
+  uint64_t next{ 0 };
+  uint64_t current{ 0 };
+};
+
+#endif  // FRAME_BROADCAST_HPP
@@ -18,8 +18,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -27,7 +29,16 @@
 #include <unordered_map>
 
 #include "../src/ini_parser.cpp"
+#include "decision_record.hpp"
 #include "dice_manager.hpp"
+#include "frame_broadcast.hpp"
+#include "game_event.hpp"
+#include "game_rules.hpp"
+#include "game_snapshot.hpp"
+#include "mcts.hpp"
+#include "policy.hpp"
+#include "stats_store.hpp"
+#include "turn_model.hpp"
 
 /**
  * @struct Player
@@ -36,11 +47,21 @@
  * @var Player::name Nome do jogador
  * @var Player::brains Quantidade de cérebros acumulados
  * @var Player::turns Número de turnos jogados
+ * @var Player::busts Turnos perdidos por 3+ tiros
+ * @var Player::streak Turnos seguidos sem levar 3 tiros
+ * @var Player::longest_streak Maior sequência de turnos sem levar 3 tiros
+ * @var Player::tie_break Indica se o jogador chegou ao desempate
+ * @var Player::bot Política do robô (vazia para jogadores humanos)
  */
 struct Player {
   std::string name;
   size_t brains{ 0 };
   size_t turns{ 0 };
+  size_t busts{ 0 };
+  size_t streak{ 0 };
+  size_t longest_streak{ 0 };
+  bool tie_break{ false };
+  Policy bot;
 
   Player(const std::string& name) : name{ name } {}
 };
@@ -70,13 +91,50 @@ public:
   static void render();          ///< Renderiza interface gráfica
   static bool game_over();       ///< Verifica se o jogo terminou
 
+  /**
+   * @brief Prepara uma partida sem terminal, só com robôs (verificação diferencial)
+   *
+   * Depois desta chamada o game loop não lê a entrada padrão e `render()` não escreve nada;
+   * basta alternar `process_events()` e `update()` até `game_over()`.
+   * @param rules Regras da partida
+   * @param bots Política de cada jogador, na ordem da mesa
+   * @param seed Semente do gerador compartilhado (`dice_engine()`)
+   */
+  static void reset(const GameRules& rules, const std::vector<Policy>& bots, uint64_t seed);
+
+  static GameObserver observer;  ///< Recebe os eventos da partida (opcional)
+
+  /**
+   * @brief Retrato completo da partida atual (sem os nomes dos jogadores)
+   * @return false se a partida não cabe em um retrato (`GameSnapshot::fits()`)
+   */
+  static bool snapshot(GameSnapshot& s);
+
+  /**
+   * @brief Continua uma partida a partir de um retrato
+   * @param s Retrato obtido por `snapshot()`
+   * @param names Nomes dos jogadores, ativos seguidos dos eliminados
+   * @return false se o retrato não é compatível com a configuração atual (nomes, ou dados
+   *         diferentes dos da configuração em quantidade ou tipo)
+   */
+  static bool restore(const GameSnapshot& s, const std::vector<std::string>& names);
+
 private:
   // Métodos auxiliares
-  static void read_players();            ///< Lê nomes dos jogadores
-  static std::string welcome_message();  ///< Mensagem inicial do jogo
-  static std::string global_score();     ///< Gera placar global
-  static std::string scoreboard();       ///< Gera tabela de rolagens
-  static std::string message_area();     ///< Gera área de mensagens
+  static void read_players();                       ///< Lê nomes dos jogadores
+  static std::string welcome_message();             ///< Mensagem inicial do jogo
+  static std::string global_score();                ///< Gera placar global
+  static std::string scoreboard();                  ///< Gera tabela de rolagens
+  static std::string message_area();                ///< Gera área de mensagens
+  static std::string odds_panel();                  ///< Gera painel de probabilidades do turno
+  static void prepare_odds();                       ///< Pré-calcula as tabelas de probabilidades
+  static void record_stats();                       ///< Salva as estatísticas da partida
+  static void log_decision(bool hold);              ///< Registra a decisão do jogador da vez
+  static bool save_game(const std::string& path);   ///< Grava a partida em arquivo
+  static bool load_game(const std::string& path);   ///< Retoma uma partida gravada
+  static GameRules current_rules();                 ///< Regras da partida (dados e objetivo)
+  static Policy make_bot(const std::string& name, size_t seats);  ///< Robô de um nome "@..."
+  static TurnView turn_view();                      ///< Decisão pendente do jogador da vez
 
   /**
    * @enum State
@@ -108,9 +166,13 @@ private:
     END,              ///< Fim natural do jogo
     INVALID_SIZE,     ///< Número inválido de jogadores
     LESS_THAN_TWO,    ///< Menos de 2 jogadores
-    INVALID_OPTION    ///< Opção inválida do menu
+    INVALID_OPTION,   ///< Opção inválida do menu
+    SAVING,           ///< Partida gravada em arquivo
+    RESUMING          ///< Retomando uma partida gravada
   };
 
+  static void notify(State previous);  ///< Emite o evento da transição a partir de `previous`
+
   // Áreas de armazenamento de dados
   static DiceBag dra;  ///< Área de rolagem (Dice Rolling Area)
   static DiceBag bsa;  ///< Armazenamento de cérebros (Brain Storage Area)
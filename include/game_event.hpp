@@ -0,0 +1,83 @@
+/**
+ * @file game_event.hpp
+ * @brief Eventos de uma partida, emitidos pelo jogo e pelos motores de simulação
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo define a sequência de eventos que descreve uma partida de forma independente
+ * da implementação. `GameController` e `Simulator` emitem os mesmos eventos para a mesma
+ * semente, o que permite compará-los evento a evento (`zverify`).
+ */
+
+#ifndef GAME_EVENT_HPP
+#define GAME_EVENT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+
+/**
+ * @enum GameEventKind
+ * @brief Tipo de evento da partida
+ */
+enum GameEventKind : uint8_t {
+  FIRST_PLAYER,  ///< Jogador inicial sorteado (`INIT_PLAYER`)
+  ROLL,          ///< Três dados rolados (`ROLLING`)
+  HOLD,          ///< Jogador parou e guardou os cérebros (`HOLDING`)
+  BUST,          ///< Turno perdido por 3+ tiros (`FORCE_QUIT`)
+  TIE,           ///< Desempate entre os jogadores restantes (`PARSING_TIE` → `INIT_TIE`)
+  GAME_END       ///< Fim da partida (`PARSING_TIE` → `END`)
+};
+
+/**
+ * @struct GameEvent
+ * @brief Evento da partida
+ *
+ * @var GameEvent::kind Tipo do evento
+ * @var GameEvent::player Índice do jogador da vez na lista de jogadores ativos
+ * @var GameEvent::dice Dados em jogo (`dra` + `bsa` + `ssa` + dados rolados)
+ * @var GameEvent::types Tipos dos dados rolados, na ordem da rolagem (ROLL)
+ * @var GameEvent::faces Faces dos dados rolados (ROLL)
+ * @var GameEvent::value Cérebros do jogador (HOLD/BUST) ou jogadores restantes (TIE/GAME_END)
+ */
+struct GameEvent {
+  GameEventKind kind{ FIRST_PLAYER };
+  uint8_t player{ 0 };
+  uint8_t dice{ 0 };
+  uint8_t types[3]{};
+  char faces[3]{};
+  uint32_t value{ 0 };
+
+  bool operator==(const GameEvent& o) const {
+    return kind == o.kind and player == o.player and dice == o.dice and value == o.value
+           and std::equal(types, types + 3, o.types) and std::equal(faces, faces + 3, o.faces);
+  }
+  bool operator!=(const GameEvent& o) const { return not(*this == o); }
+
+  /// @brief Descrição legível do evento
+  std::string str() const {
+    static const char* names[]{ "first", "roll", "hold", "bust", "tie", "end" };
+    std::ostringstream oss;
+    oss << names[kind] << " player=" << int(player);
+    if (kind == ROLL) {
+      oss << " dice=";
+      for (int i = 0; i < 3; ++i) {
+        oss << "WTS"[types[i] % 3] << faces[i] << (i < 2 ? "," : "");
+      }
+    }
+    if (kind == ROLL or kind == HOLD or kind == BUST) {
+      oss << " in_play=" << int(dice);
+    }
+    if (kind != FIRST_PLAYER and kind != ROLL) {
+      oss << " value=" << value;
+    }
+    return oss.str();
+  }
+};
+
+/// @brief Observador de eventos da partida
+using GameObserver = std::function<void(const GameEvent&)>;
+
+#endif  // GAME_EVENT_HPP
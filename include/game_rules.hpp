@@ -0,0 +1,147 @@
+/**
+ * @file game_rules.hpp
+ * @brief Regras configuráveis do jogo (zdice.ini)
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo reúne os parâmetros de regra lidos do arquivo de configuração, para que o
+ * jogo interativo e as ferramentas de simulação usem exatamente a mesma configuração.
+ */
+
+#ifndef GAME_RULES_HPP
+#define GAME_RULES_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "../src/ini_parser.cpp"
+#include "dice_manager.hpp"
+#include "turn_model.hpp"
+
+/**
+ * @struct GameRules
+ * @brief Parâmetros de regra de uma partida
+ *
+ * @var GameRules::dice_and_faces Tipos, quantidades e faces dos dados
+ * @var GameRules::brains_to_win Cérebros necessários para vencer
+ */
+struct GameRules {
+  DiceConfig dice_and_faces{ DiceBag{}.dice_and_faces };
+  size_t brains_to_win{ 13 };
+
+  /// @brief Quantidade total de dados no saco
+  size_t total_dice() const {
+    size_t total{ 0 };
+    for (const auto& t : dice_and_faces) {
+      total += std::get<1>(t);
+    }
+    return total;
+  }
+
+  /**
+   * @brief Indica se as regras cabem nos modelos do turno (simulador, robôs e ferramentas)
+   *
+   * Um turno precisa de pelo menos 3 dados, e `TurnState` guarda no máximo
+   * `DieSeq::capacity` dados em cada sequência. O jogo interativo aceita mais dados, mas
+   * sem painel de probabilidades e sem robôs.
+   *
+   * @param error Motivo, quando as regras não cabem
+   */
+  bool playable(std::string& error) const {
+    auto total = total_dice();
+    if (total < TurnModel::dice_per_roll) {
+      error = "the rules need at least " + std::to_string(TurnModel::dice_per_roll) + " dice";
+    } else if (total > DieSeq::capacity) {
+      error = "the rules use " + std::to_string(total) + " dice, at most "
+              + std::to_string(DieSeq::capacity) + " are supported";
+    } else {
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Representação canônica das regras efetivas
+   *
+   * Duas configurações com a mesma representação jogam exatamente as mesmas partidas,
+   * independente da ordem ou da formatação das chaves no arquivo.
+   */
+  std::string canonical() const {
+    std::string result = "brains_to_win=" + std::to_string(brains_to_win);
+    for (const auto& [type, count, faces] : dice_and_faces) {
+      result += ";" + std::to_string(type) + ":" + std::to_string(count) + ":" + faces;
+    }
+    return result;
+  }
+
+  /// @brief Hash FNV-1a de 64 bits da representação canônica
+  uint64_t hash() const {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : canonical()) {
+      h = (h ^ c) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  /**
+   * @brief Aplica as chaves reconhecidas do arquivo de configuração
+   *
+   * Valores inválidos (não numéricos, ou faces fora de b/f/s) são ignorados.
+   */
+  void load(const IniParser& parser) {
+    for (const auto& p : parser.get_map()) {
+      set(p.first, p.second);
+    }
+  }
+
+  /**
+   * @brief Aplica uma chave de regra (`brains_to_win`, `weak_dice`, `weak_die_faces`, ...)
+   * @return false se a chave não é de regra ou o valor é inválido (nada é alterado)
+   */
+  bool set(const std::string& key, const std::string& value) {
+    static const std::unordered_map<std::string, std::pair<size_t, bool>> members{
+      { "weak_dice", { 0, true } },   { "weak_die_faces", { 0, false } },
+      { "tough_dice", { 1, true } },  { "tough_die_faces", { 1, false } },
+      { "strong_dice", { 2, true } }, { "strong_die_faces", { 2, false } },
+    };
+    // Até 9 algarismos: `std::stoi` não pode estourar.
+    auto is_number = [](const std::string& s) {
+      return not s.empty() and s.size() <= 9 and std::all_of(s.begin(), s.end(), [](char c) {
+        return std::isdigit(c);
+      });
+    };
+
+    if (key == "brains_to_win") {
+      if (not is_number(value)) {
+        return false;
+      }
+      brains_to_win = std::stoi(value);
+      return true;
+    }
+    auto it = members.find(key);
+    if (it == members.end()) {
+      return false;
+    }
+    if (it->second.second) {
+      if (not is_number(value)) {
+        return false;
+      }
+      std::get<1>(dice_and_faces[it->second.first]) = std::stoi(value);
+      return true;
+    }
+    bool isvalid = not value.empty() and std::all_of(value.begin(), value.end(), [](char c) {
+      return c == 'b' or c == 'f' or c == 's';
+    });
+    if (isvalid) {
+      std::get<2>(dice_and_faces[it->second.first]) = value;
+    }
+    return isvalid;
+  }
+};
+
+#endif  // GAME_RULES_HPP
@@ -0,0 +1,200 @@
+/**
+ * @file game_snapshot.hpp
+ * @brief Retrato compacto e de tamanho fixo do estado de uma partida
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo define `GameSnapshot`, uma estrutura POD de 92 bytes com tudo o que define
+ * uma partida: os dados de `dra`, `bsa`, `ssa` e da rolagem em andamento (um nibble por dado),
+ * os jogadores ativos e eliminados, o jogador da vez, o estado e o desempate.
+ *
+ * Copiar um retrato é uma cópia de memória, então robôs de busca podem clonar uma posição
+ * milhões de vezes por segundo (`Simulator::snapshot()`/`restore()`); a codificação binária
+ * (`encode()`/`decode()`) é estável e little-endian, usada para salvar partidas em arquivo.
+ *
+ * O gerador aleatório não faz parte do retrato: quem restaura escolhe a semente.
+ */
+
+#ifndef GAME_SNAPSHOT_HPP
+#define GAME_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "dice_manager.hpp"
+
+/**
+ * @struct SnapshotPlayer
+ * @brief Jogador dentro do retrato
+ *
+ * @var SnapshotPlayer::brains Cérebros guardados
+ * @var SnapshotPlayer::turns Turnos jogados
+ * @var SnapshotPlayer::busts Turnos perdidos por 3+ tiros (satura em 255)
+ * @var SnapshotPlayer::streak Turnos seguidos sem levar 3 tiros (satura em 255)
+ * @var SnapshotPlayer::longest_streak Maior sequência sem levar 3 tiros (satura em 255)
+ * @var SnapshotPlayer::flags Bits 0-3: posição original na mesa; bit 4: chegou ao desempate
+ */
+struct SnapshotPlayer {
+  uint16_t brains;
+  uint16_t turns;
+  uint8_t busts;
+  uint8_t streak;
+  uint8_t longest_streak;
+  uint8_t flags;
+
+  size_t seat() const { return flags & 0x0f; }
+  bool tie_break() const { return (flags & 0x10) != 0; }
+};
+
+/**
+ * @struct GameSnapshot
+ * @brief Estado completo de uma partida
+ *
+ * @var GameSnapshot::version Versão do formato
+ * @var GameSnapshot::state Estado da máquina de estados (`GameController::State`; 0 no simulador)
+ * @var GameSnapshot::idx Índice do jogador da vez entre os ativos
+ * @var GameSnapshot::flags Bit 0: desempate em andamento; bit 1: houve desempate; bit 2: fim
+ * @var GameSnapshot::active Jogadores ativos (os primeiros de `players`)
+ * @var GameSnapshot::removed Jogadores eliminados (após os ativos)
+ * @var GameSnapshot::first Posição do jogador sorteado para começar
+ * @var GameSnapshot::segments Dados em `dra`, `bsa`, `ssa` e na rolagem, nesta ordem
+ * @var GameSnapshot::dice Dados, um nibble cada: bits 0-1 tipo, bits 2-3 face (0 = não rolado,
+ *                         1 = cérebro, 2 = tiro, 3 = pegada)
+ * @var GameSnapshot::players Jogadores ativos seguidos dos eliminados
+ */
+struct GameSnapshot {
+  static constexpr uint8_t version_value = 1;
+  static constexpr size_t max_dice = 32;
+  static constexpr size_t max_players = 8;
+  static constexpr size_t encoded_size = 11 + max_dice / 2 + 8 * max_players;
+
+  enum Segment { DRA, BSA, SSA, ROLLED };
+  enum Flag : uint8_t { TIE = 1, TIE_BREAK = 2, FINISHED = 4 };
+
+  uint8_t version{ version_value };
+  uint8_t state{ 0 };
+  uint8_t idx{ 0 };
+  uint8_t flags{ 0 };
+  uint8_t active{ 0 };
+  uint8_t removed{ 0 };
+  uint8_t first{ 0 };
+  uint8_t segments[4]{};
+  uint8_t dice[max_dice / 2]{};
+  SnapshotPlayer players[max_players]{};
+
+  /// @brief Indica se uma partida com `players` jogadores e `dice` dados cabe no retrato
+  static constexpr bool fits(size_t players, size_t dice) {
+    return players <= max_players and dice <= max_dice;
+  }
+
+  /// @brief Quantidade total de dados guardados
+  size_t dice_count() const { return segments[0] + segments[1] + segments[2] + segments[3]; }
+
+  /**
+   * @brief Acrescenta um dado ao segmento informado (os segmentos são gravados em ordem)
+   * @return false se o retrato já tem `max_dice` dados (o dado não é guardado)
+   */
+  bool push_die(Segment segment, uint8_t type, char face) {
+    auto i = dice_count();
+    if (i == max_dice) {
+      return false;
+    }
+    set_die(i, type, face);
+    segments[segment]++;
+    return true;
+  }
+
+  /// @brief Substitui o i-ésimo dado guardado (sem mudar os segmentos)
+  void set_die(size_t i, uint8_t type, char face) {
+    uint8_t code = face == BRAIN ? 1 : face == SHOT ? 2 : face == RUN ? 3 : 0;
+    uint8_t nibble = (type & 0x03) | code << 2;
+    dice[i / 2] = i % 2 == 0 ? (dice[i / 2] & 0xf0) | nibble : (dice[i / 2] & 0x0f) | nibble << 4;
+  }
+
+  /// @brief Tipo do i-ésimo dado guardado
+  uint8_t die_type(size_t i) const { return nibble(i) & 0x03; }
+
+  /// @brief Face do i-ésimo dado guardado (0 se não rolado)
+  char die_face(size_t i) const {
+    static const char faces[]{ 0, BRAIN, SHOT, RUN };
+    return faces[nibble(i) >> 2];
+  }
+
+  /// @brief Primeiro índice do segmento em `dice`
+  size_t segment_begin(Segment segment) const {
+    size_t begin = 0;
+    for (int s = 0; s < segment; ++s) {
+      begin += segments[s];
+    }
+    return begin;
+  }
+
+  /// @brief Codifica o retrato em `encoded_size` bytes (little-endian)
+  void encode(uint8_t* out) const {
+    const uint8_t head[]{ version, state, idx, flags, active, removed, first,
+                          segments[0], segments[1], segments[2], segments[3] };
+    auto p = out;
+    for (auto b : head) {
+      *p++ = b;
+    }
+    for (auto b : dice) {
+      *p++ = b;
+    }
+    for (const auto& pl : players) {
+      *p++ = static_cast<uint8_t>(pl.brains);
+      *p++ = static_cast<uint8_t>(pl.brains >> 8);
+      *p++ = static_cast<uint8_t>(pl.turns);
+      *p++ = static_cast<uint8_t>(pl.turns >> 8);
+      *p++ = pl.busts;
+      *p++ = pl.streak;
+      *p++ = pl.longest_streak;
+      *p++ = pl.flags;
+    }
+  }
+
+  /**
+   * @brief Decodifica um retrato gravado por `encode()`
+   * @return false se a versão for desconhecida ou o conteúdo for inconsistente
+   */
+  bool decode(const uint8_t* in) {
+    GameSnapshot s;
+    auto p = in;
+    s.version = *p++;
+    s.state = *p++;
+    s.idx = *p++;
+    s.flags = *p++;
+    s.active = *p++;
+    s.removed = *p++;
+    s.first = *p++;
+    s.segments[0] = *p++;
+    s.segments[1] = *p++;
+    s.segments[2] = *p++;
+    s.segments[3] = *p++;
+    for (auto& b : s.dice) {
+      b = *p++;
+    }
+    for (auto& pl : s.players) {
+      pl.brains = static_cast<uint16_t>(p[0] | p[1] << 8);
+      pl.turns = static_cast<uint16_t>(p[2] | p[3] << 8);
+      pl.busts = p[4];
+      pl.streak = p[5];
+      pl.longest_streak = p[6];
+      pl.flags = p[7];
+      p += 8;
+    }
+    if (s.version != version_value or s.dice_count() > max_dice
+        or s.active + s.removed > max_players or (s.active > 0 and s.idx >= s.active)) {
+      return false;
+    }
+    *this = s;
+    return true;
+  }
+
+private:
+  uint8_t nibble(size_t i) const { return i % 2 == 0 ? dice[i / 2] & 0x0f : dice[i / 2] >> 4; }
+};
+
+static_assert(std::is_trivially_copyable_v<GameSnapshot>);
+
+#endif  // GAME_SNAPSHOT_HPP
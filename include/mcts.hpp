@@ -0,0 +1,477 @@
+/**
+ * @file mcts.hpp
+ * @brief Robô de busca em árvore Monte Carlo (MCTS) para a decisão de rolar ou parar
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * A árvore cobre o turno do jogador da vez: nós de decisão (rolar ou parar) se alternam com
+ * nós de acaso, cujos filhos são os estados possíveis após sortear e rolar 3 dados. Quando o
+ * turno termina (parou, levou 3 tiros ou o saco acabou), a partida é jogada até o fim no
+ * `Simulator`, com todos os jogadores usando `racing_policy()`, e o valor é a vitória ou a
+ * derrota do jogador da vez. Assim a busca leva em conta a corrida pelos `brains_to_win`.
+ *
+ * A ordem dos dados desconhecidos no saco é sorteada de novo a cada iteração: o robô só usa
+ * o que um jogador enxerga na mesa.
+ *
+ * Os nós ficam em uma arena por decisão, liberada em O(1). Depois de rolar, a subárvore do
+ * resultado que de fato saiu é copiada para a outra arena e reaproveitada na decisão
+ * seguinte. Cada linha de execução busca em sua própria árvore (paralelismo na raiz) até o
+ * fim do orçamento de tempo; as visitas da raiz são somadas para escolher a jogada.
+ *
+ * As linhas de execução e suas arenas são criadas na primeira decisão e vivem tanto quanto o
+ * robô: nas decisões seguintes elas só são acordadas, então o orçamento de tempo é todo de
+ * busca.
+ */
+
+#ifndef MCTS_HPP
+#define MCTS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "game_rules.hpp"
+#include "game_snapshot.hpp"
+#include "simulator.hpp"
+
+/**
+ * @brief Política das simulações: limiar de cérebros, mas sem parar atrás de quem já venceu
+ *
+ * Se um adversário já tem `brains_to_win`, parar com menos cérebros que ele é perder;
+ * nesse caso a política só para quando passa à frente.
+ */
+inline Policy racing_policy(size_t brains) {
+  auto threshold = threshold_policy(brains);
+  return [threshold](const TurnView& v) {
+    if (v.best_opponent >= v.brains_to_win) {
+      return v.banked + v.turn.hand.size() > v.best_opponent;
+    }
+    return threshold(v);
+  };
+}
+
+/**
+ * @struct MctsNode
+ * @brief Nó da árvore de busca (os filhos formam uma lista ligada dentro da arena)
+ *
+ * @var MctsNode::key Estado do turno (nós de decisão) ou 0
+ * @var MctsNode::child Primeiro filho (0 = nenhum; a raiz nunca é filha)
+ * @var MctsNode::sibling Próximo irmão (0 = nenhum)
+ * @var MctsNode::visits Iterações que passaram pelo nó
+ * @var MctsNode::wins Vitórias do jogador da vez nessas iterações
+ * @var MctsNode::kind Tipo do nó
+ */
+struct MctsNode {
+  enum Kind : uint8_t { DECISION, HOLD, ROLL, TURN_OVER };
+
+  uint64_t key{ 0 };
+  uint32_t child{ 0 };
+  uint32_t sibling{ 0 };
+  uint32_t visits{ 0 };
+  float wins{ 0 };
+  Kind kind{ DECISION };
+};
+
+static_assert(std::is_trivially_destructible_v<MctsNode>);
+
+/**
+ * @class NodeArena
+ * @brief Bloco de nós de capacidade fixa, liberado de uma vez
+ */
+class NodeArena {
+public:
+  explicit NodeArena(size_t capacity) { nodes.reserve(capacity); }
+
+  /// @brief Cria um nó; retorna 0 se a arena estiver cheia
+  uint32_t make(MctsNode::Kind kind, uint64_t key = 0) {
+    if (nodes.size() == nodes.capacity()) {
+      return 0;
+    }
+    nodes.push_back({ key, 0, 0, 0, 0, kind });
+    return static_cast<uint32_t>(nodes.size() - 1);
+  }
+
+  /// @brief Cria um nó como primeiro filho de `parent`; retorna 0 se a arena estiver cheia
+  uint32_t make_child(uint32_t parent, MctsNode::Kind kind, uint64_t key = 0) {
+    auto n = make(kind, key);
+    if (n != 0) {
+      nodes[n].sibling = nodes[parent].child;
+      nodes[parent].child = n;
+    }
+    return n;
+  }
+
+  /// @brief Filho de `parent` com o tipo e a chave informados (0 se não existir)
+  uint32_t find_child(uint32_t parent, MctsNode::Kind kind, uint64_t key = 0) const {
+    for (auto c = nodes[parent].child; c != 0; c = nodes[c].sibling) {
+      if (nodes[c].kind == kind and nodes[c].key == key) {
+        return c;
+      }
+    }
+    return 0;
+  }
+
+  /// @brief Libera todos os nós (os nós não têm destrutor, então é O(1))
+  void clear() { nodes.clear(); }
+
+  /**
+   * @brief Substitui o conteúdo pela subárvore `root` de outra arena
+   *
+   * A subárvore é copiada em largura e sua raiz passa a ser o nó 0.
+   */
+  void adopt(const NodeArena& from, uint32_t root) {
+    clear();
+    sources.clear();
+    nodes.push_back(from.nodes[root]);
+    sources.push_back(root);
+    for (size_t dst = 0; dst < nodes.size(); ++dst) {
+      uint32_t previous = 0;
+      nodes[dst].child = 0;
+      for (auto c = from.nodes[sources[dst]].child; c != 0 and nodes.size() < nodes.capacity();
+           c = from.nodes[c].sibling) {
+        auto copy = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(from.nodes[c]);
+        nodes.back().sibling = 0;
+        sources.push_back(c);
+        (previous == 0 ? nodes[dst].child : nodes[previous].sibling) = copy;
+        previous = copy;
+      }
+    }
+    nodes[0].sibling = 0;
+  }
+
+  MctsNode& operator[](uint32_t i) { return nodes[i]; }
+  const MctsNode& operator[](uint32_t i) const { return nodes[i]; }
+  size_t size() const { return nodes.size(); }
+
+private:
+  std::vector<MctsNode> nodes;
+  std::vector<uint32_t> sources;
+};
+
+/**
+ * @class MctsBot
+ * @brief Robô que decide entre rolar e parar por busca Monte Carlo com tempo limitado
+ */
+class MctsBot {
+public:
+  /**
+   * @struct Options
+   * @brief Parâmetros da busca
+   *
+   * @var Options::budget Tempo de busca por decisão (a folga mantém a decisão abaixo de 10 ms)
+   * @var Options::threads Linhas de execução (árvores independentes)
+   * @var Options::exploration Constante de exploração do UCT
+   * @var Options::rollout_brains Limiar de `racing_policy()` nas simulações
+   * @var Options::arena_nodes Capacidade de cada arena, em nós
+   */
+  struct Options {
+    std::chrono::microseconds budget{ 9000 };
+    size_t threads{ std::max(1u, std::thread::hardware_concurrency()) };
+    double exploration{ 0.7 };
+    size_t rollout_brains{ 3 };
+    size_t arena_nodes{ size_t(1) << 16 };
+  };
+
+  /**
+   * @struct Stats
+   * @brief Números da última decisão
+   *
+   * @var Stats::iterations Iterações feitas por todas as linhas de execução
+   * @var Stats::reused Visitas herdadas da decisão anterior
+   * @var Stats::nodes Nós nas árvores ao final
+   */
+  struct Stats {
+    size_t iterations{ 0 };
+    size_t reused{ 0 };
+    size_t nodes{ 0 };
+  };
+
+  explicit MctsBot(const GameRules& rules) : MctsBot(rules, Options{}) {}
+
+  MctsBot(const GameRules& rules, Options options)
+    : options{ options }, rules{ rules }, rollout{ racing_policy(options.rollout_brains) } {}
+
+  MctsBot(const MctsBot&) = delete;
+  MctsBot& operator=(const MctsBot&) = delete;
+
+  ~MctsBot() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& w : workers) {
+      w.join();
+    }
+  }
+
+  /**
+   * @brief Decide a jogada do jogador da vez
+   * @param position Partida no momento da decisão (`START` ou `SHOW_SCOREBOARD`)
+   * @return true para parar, false para rolar
+   */
+  bool hold(const GameSnapshot& position) {
+    auto deadline = std::chrono::steady_clock::now() + options.budget;
+    if (trees.empty()) {
+      start();
+    }
+    root = position;
+    trees[0]->sim.restore(position);
+    auto view = trees[0]->sim.view();
+    auto key = state_key(view);
+    auto turns = trees[0]->sim.result().turns;
+    bool resume = rolled and view.seat == seat and turns == this->turns;
+
+    last = {};
+    for (auto& t : trees) {
+      t->reset(resume, key);
+      last.reused += t->arena()[0].visits;
+    }
+    seat = view.seat;
+    this->turns = turns;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->deadline = deadline;
+      running = workers.size();
+      generation++;
+    }
+    wake.notify_all();
+    search(*trees[0], deadline);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      done.wait(lock, [this] { return running == 0; });
+    }
+
+    double hold_visits = 0, roll_visits = 0;
+    for (auto& t : trees) {
+      const auto& a = t->arena();
+      auto h = a.find_child(0, MctsNode::HOLD), r = a.find_child(0, MctsNode::ROLL);
+      hold_visits += h != 0 ? a[h].visits : 0;
+      roll_visits += r != 0 ? a[r].visits : 0;
+      last.iterations += t->iterations;
+      last.nodes += a.size();
+    }
+    rolled = roll_visits > hold_visits;
+    return not rolled;
+  }
+
+  /// @brief Números da última decisão
+  const Stats& stats() const { return last; }
+
+  /**
+   * @brief Adapta o robô a uma `Policy`
+   * @param bot Robô compartilhado (uma árvore por jogador)
+   * @param position Fornece a partida no momento da decisão
+   */
+  static Policy as_policy(std::shared_ptr<MctsBot> bot, std::function<GameSnapshot()> position) {
+    return [bot, position](const TurnView&) { return bot->hold(position()); };
+  }
+
+private:
+  /// @brief Árvore de uma linha de execução: duas arenas (atual e a de reaproveitamento)
+  struct Tree {
+    Tree(const GameRules& rules, size_t capacity)
+      : sim{ rules }, arenas{ NodeArena(capacity), NodeArena(capacity) } {}
+
+    Simulator sim;
+    NodeArena arenas[2];
+    int current{ 0 };
+    size_t iterations{ 0 };
+    std::vector<uint32_t> path;
+
+    NodeArena& arena() { return arenas[current]; }
+
+    /// @brief Reaproveita o resultado da rolagem anterior que tem a chave `key`, ou recomeça
+    void reset(bool resume, uint64_t key) {
+      iterations = 0;
+      auto& a = arena();
+      uint32_t next = 0;
+      if (resume and a.size() > 0) {
+        auto roll = a.find_child(0, MctsNode::ROLL);
+        next = roll != 0 ? a.find_child(roll, MctsNode::DECISION, key) : 0;
+      }
+      if (next != 0) {
+        arenas[1 - current].adopt(a, next);
+        a.clear();
+        current = 1 - current;
+      } else {
+        a.clear();
+        a.make(MctsNode::DECISION, key);
+      }
+    }
+  };
+
+  Options options;
+  GameRules rules;
+  Policy rollout;
+  std::vector<std::unique_ptr<Tree>> trees;
+  std::vector<std::thread> workers;  ///< Buscam nas árvores 1 em diante; a 0 é de `hold()`
+
+  // Sincronização com `workers`: cada decisão incrementa `generation`.
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::chrono::steady_clock::time_point deadline;
+  uint64_t generation{ 0 };
+  size_t running{ 0 };
+  bool stopping{ false };
+
+  GameSnapshot root;
+  Stats last;
+  size_t seat{ 0 };
+  size_t turns{ 0 };
+  bool rolled{ false };
+
+  /// @brief Cria as árvores e as linhas de execução (na primeira decisão)
+  void start() {
+    std::random_device rd;
+    for (size_t i = 0; i < std::max<size_t>(1, options.threads); ++i) {
+      trees.push_back(std::make_unique<Tree>(rules, options.arena_nodes));
+      Simulator::seed_rng(trees.back()->sim.engine(), (uint64_t(rd()) << 32) ^ rd() ^ i);
+    }
+    for (size_t i = 1; i < trees.size(); ++i) {
+      workers.emplace_back([this, i] { work(*trees[i]); });
+    }
+  }
+
+  /// @brief Laço de uma linha de execução: espera cada decisão e busca até o prazo
+  void work(Tree& t) {
+    uint64_t seen = 0;
+    while (true) {
+      std::chrono::steady_clock::time_point until;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return stopping or generation != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = generation;
+        until = deadline;
+      }
+      search(t, until);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--running == 0) {
+        done.notify_one();
+      }
+    }
+  }
+
+  /// @brief Chave do estado do turno (dados conhecidos, contagens do saco e da mão, tiros)
+  static uint64_t state_key(const TurnView& v) {
+    return TurnKeyHash{}(v.turn.key()) | 1;
+  }
+
+  /// @brief Sorteia de novo a ordem dos dados ainda não rolados de `dra`
+  static void determinize(GameSnapshot& s, std::mt19937& rng) {
+    size_t unknown = s.segments[GameSnapshot::DRA];
+    while (unknown > 0 and s.die_face(unknown - 1) != 0) {
+      --unknown;
+    }
+    uint8_t types[GameSnapshot::max_dice];
+    for (size_t i = 0; i < unknown; ++i) {
+      types[i] = s.die_type(i);
+    }
+    std::shuffle(types, types + unknown, rng);
+    for (size_t i = 0; i < unknown; ++i) {
+      s.set_die(i, types[i], 0);
+    }
+  }
+
+  /// @brief Filho de um nó de decisão escolhido pelo UCT (cria rolar e parar se preciso)
+  uint32_t select(NodeArena& a, uint32_t node) const {
+    if (a[node].child == 0) {
+      a.make_child(node, MctsNode::HOLD);
+      a.make_child(node, MctsNode::ROLL);
+    }
+    uint32_t best = 0;
+    double best_score = -1;
+    auto log_n = std::log(double(a[node].visits) + 1);
+    for (auto c = a[node].child; c != 0; c = a[c].sibling) {
+      if (a[c].visits == 0) {
+        return c;
+      }
+      auto score = a[c].wins / a[c].visits + options.exploration * std::sqrt(log_n / a[c].visits);
+      if (score > best_score) {
+        best_score = score;
+        best = c;
+      }
+    }
+    return best;
+  }
+
+  /// @brief Uma iteração: descida na árvore, simulação até o fim da partida e retropropagação
+  void iterate(Tree& t) {
+    auto& a = t.arena();
+    auto& sim = t.sim;
+    auto position = root;
+    determinize(position, sim.engine());
+    sim.restore(position);
+
+    t.path.clear();
+    t.path.push_back(0);
+    for (uint32_t node = 0;;) {
+      auto action = select(a, node);
+      if (action == 0) {
+        break;  // Arena cheia: só simula
+      }
+      t.path.push_back(action);
+      bool hold = a[action].kind == MctsNode::HOLD;
+      sim.decide(hold);
+      if (hold) {
+        break;
+      }
+      if (sim.over() or sim.result().turns != turns) {
+        auto over = a.find_child(action, MctsNode::TURN_OVER);
+        over = over != 0 ? over : a.make_child(action, MctsNode::TURN_OVER);
+        if (over != 0) {
+          t.path.push_back(over);
+        }
+        break;
+      }
+      auto key = state_key(sim.view());
+      auto next = a.find_child(action, MctsNode::DECISION, key);
+      if (next == 0) {
+        next = a.make_child(action, MctsNode::DECISION, key);
+        if (next != 0) {
+          t.path.push_back(next);
+        }
+        break;
+      }
+      t.path.push_back(next);
+      node = next;
+    }
+
+    while (not sim.over()) {
+      sim.decide(rollout(sim.view()));
+    }
+    auto r = sim.result();
+    float value = r.finished ? (r.winner == int(seat) ? 1.0f : 0.0f) : 0.5f;
+    for (auto n : t.path) {
+      a[n].visits++;
+      a[n].wins += value;
+    }
+    t.iterations++;
+  }
+
+  /// @brief Itera até o prazo (ao menos uma iteração)
+  void search(Tree& t, std::chrono::steady_clock::time_point deadline) {
+    do {
+      iterate(t);
+    } while (std::chrono::steady_clock::now() < deadline);
+  }
+};
+
+#endif  // MCTS_HPP
@@ -0,0 +1,377 @@
+/**
+ * @file policy.hpp
+ * @brief Política tabular de robôs (rolar ou parar), treinada por auto-jogo
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo implementa a tabela de decisões gerada pelo `ztrain`. Cada decisão é
+ * resumida em uma célula (cérebros na mão, tiros, cérebros que faltam, diferença para o
+ * líder, desempate, número de jogadores e dados restantes no saco) e a tabela guarda, por
+ * célula, a ação (parar ou rolar) e a chance de vitória estimada para ela.
+ *
+ * O arquivo (versão 2) é um cabeçalho de 256 bytes seguido da tabela densa, alinhada em 64
+ * bytes. O cabeçalho registra as regras para as quais a tabela foi gerada (`dice_and_faces`,
+ * `brains_to_win`, dados por rolagem, tiros que encerram o turno), o formato das células e
+ * uma soma de verificação da tabela. O jogo mapeia o arquivo somente para leitura (`mmap`):
+ * carregar é instantâneo e processos diferentes compartilham as mesmas páginas em memória.
+ *
+ * A tabela é carregada pelo jogo (`bot_policy` no zdice.ini) para os jogadores "@policy".
+ */
+
+#ifndef POLICY_HPP
+#define POLICY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "game_rules.hpp"
+#include "simulator.hpp"
+
+/**
+ * @struct PolicyEntry
+ * @brief Célula da tabela
+ *
+ * @var PolicyEntry::hold 1 para parar, 0 para rolar
+ * @var PolicyEntry::value Chance de vitória estimada da ação, em 1/65535 (0 = desconhecida)
+ */
+struct PolicyEntry {
+  uint8_t hold;
+  uint8_t reserved;
+  uint16_t value;
+};
+
+/**
+ * @struct PolicyFileHeader
+ * @brief Cabeçalho do arquivo de política (versão 2)
+ *
+ * @var PolicyFileHeader::levels Tamanho de cada dimensão das células, na ordem de `cell()`
+ * @var PolicyFileHeader::dice Tipo, quantidade e faces de cada tipo de dado (faces com '\0')
+ * @var PolicyFileHeader::checksum FNV-1a de 64 bits das palavras de 64 bits da tabela
+ */
+struct PolicyFileHeader {
+  struct Dice {
+    uint32_t type;
+    uint32_t count;
+    char faces[24];
+  };
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t entry_size;
+  uint64_t cells;
+  uint64_t rules_hash;
+  uint64_t checksum;
+  uint32_t brains_to_win;
+  uint32_t dice_per_roll;
+  uint32_t shots_to_bust;
+  uint32_t dice_kinds;
+  uint32_t levels[7];
+  uint32_t reserved;
+  Dice dice[3];
+  uint8_t padding[72];
+};
+
+static_assert(sizeof(PolicyEntry) == 4);
+static_assert(sizeof(PolicyFileHeader) == 256);
+
+/**
+ * @class PolicyTable
+ * @brief Tabela de decisões indexada pelas características da jogada
+ *
+ * Uma tabela criada pelo construtor é própria e pode ser alterada (`set()`); uma tabela
+ * carregada por `load()` aponta para o arquivo mapeado e é somente leitura.
+ */
+class PolicyTable {
+public:
+  static constexpr size_t hand_levels = 16;    ///< Cérebros na mão (0 a 15+)
+  static constexpr size_t shot_levels = 3;     ///< Tiros no turno (0 a 2)
+  static constexpr size_t need_levels = 16;    ///< Cérebros que faltam para vencer (0 a 15+)
+  static constexpr size_t margin_levels = 16;  ///< Melhor adversário − guardados (-7 a 8+)
+  static constexpr size_t tie_levels = 2;      ///< Fora ou dentro do desempate
+  static constexpr size_t player_levels = 3;   ///< Jogadores na mesa (2, 3, 4+)
+  static constexpr size_t bag_levels = 3;      ///< Dados em `dra` (<3, 3 a 5, 6+)
+  static constexpr size_t cells = hand_levels * shot_levels * need_levels * margin_levels
+                                  * tie_levels * player_levels * bag_levels;
+
+  /// @brief Cria uma tabela própria com a política de referência em todas as células
+  explicit PolicyTable(const GameRules& rules = {}) : built_for{ rules }, owned(cells) {
+    for (size_t c = 0; c < cells; ++c) {
+      owned[c] = { uint8_t(baseline(c) ? 1 : 0), 0, 0 };
+    }
+    entries = owned.data();
+  }
+
+  PolicyTable(const PolicyTable&) = delete;
+  PolicyTable& operator=(const PolicyTable&) = delete;
+
+  /// @brief Célula correspondente a uma decisão
+  static size_t cell(const TurnView& v) {
+    auto hand = std::min(v.turn.hand.size(), hand_levels - 1);
+    auto shots = std::min<size_t>(v.turn.shots, shot_levels - 1);
+    auto need = v.brains_to_win > v.banked ? v.brains_to_win - v.banked : 0;
+    auto margin = std::clamp<long>(long(v.best_opponent) - long(v.banked), -7, 8) + 7;
+    auto players = std::min<size_t>(std::max<size_t>(v.players, 2), 4) - 2;
+    auto bag = v.turn.drawable() < 3 ? 0 : (v.turn.drawable() < 6 ? 1 : 2);
+
+    size_t c = hand;
+    c = c * shot_levels + shots;
+    c = c * need_levels + std::min(need, need_levels - 1);
+    c = c * margin_levels + size_t(margin);
+    c = c * tie_levels + (v.tie ? 1 : 0);
+    c = c * player_levels + players;
+    c = c * bag_levels + size_t(bag);
+    return c;
+  }
+
+  /**
+   * @brief Decisão de referência de uma célula (células nunca visitadas no treino)
+   *
+   * Limiar de 3 cérebros, parando antes se a mão já garante a vitória e a liderança.
+   */
+  static bool baseline(size_t c) {
+    c /= bag_levels * player_levels * tie_levels;
+    auto margin = long(c % margin_levels) - 7;
+    c /= margin_levels;
+    auto need = c % need_levels;
+    auto hand = c / (need_levels * shot_levels);
+    return hand >= 3 or (hand >= need and long(hand) > margin);
+  }
+
+  /// @brief Indica se o robô deve parar na situação descrita
+  bool hold(const TurnView& v) const { return entries[cell(v)].hold != 0; }
+
+  /// @brief Célula da tabela (ação e chance de vitória estimada)
+  const PolicyEntry& entry(size_t c) const { return entries[c]; }
+
+  /**
+   * @brief Define a decisão de uma célula (somente em tabelas próprias)
+   * @param value Chance de vitória estimada da ação (0 a 1; negativo se desconhecida)
+   */
+  void set(size_t c, bool hold, double value = -1) {
+    auto v = value < 0 ? 0 : std::clamp(value, 1.0 / 65535, 1.0) * 65535 + 0.5;
+    owned[c] = { uint8_t(hold ? 1 : 0), 0, uint16_t(v) };
+  }
+
+  /// @brief Hash das regras para as quais a tabela foi gerada (GameRules::hash())
+  uint64_t rules() const { return built_for.hash(); }
+
+  /// @brief Indica se a tabela aponta para um arquivo mapeado
+  bool mapped() const { return mapping != nullptr; }
+
+  /**
+   * @brief Grava a tabela em disco
+   *
+   * O arquivo é escrito ao lado e renomeado por cima do anterior, então os processos que
+   * já mapearam a versão antiga continuam lendo-a sem problemas.
+   * @param error Motivo da falha, se houver
+   * @return false se as regras não cabem no cabeçalho ou o arquivo não pôde ser gravado
+   */
+  bool save(const std::string& path, std::string& error) const {
+    PolicyFileHeader h{};
+    if (not describe(built_for, h, error)) {
+      return false;
+    }
+    h.checksum = checksum(entries);
+
+    auto tmp = path + ".tmp." + std::to_string(getpid());
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      error = "could not create the file";
+      return false;
+    }
+    auto ok = write_all(fd, &h, sizeof(h)) and write_all(fd, entries, cells * sizeof(PolicyEntry))
+              and fsync(fd) == 0;
+    ::close(fd);
+    if (not ok or rename(tmp.c_str(), path.c_str()) != 0) {
+      unlink(tmp.c_str());
+      error = "could not write the file";
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Indica se uma tabela para estas regras pode ser gravada por `save()`
+   * @param error Motivo da recusa, se houver
+   */
+  static bool storable(const GameRules& rules, std::string& error) {
+    PolicyFileHeader h{};
+    return describe(rules, h, error);
+  }
+
+  /**
+   * @brief Mapeia uma tabela gravada por `save()` (somente leitura, compartilhada)
+   * @param rules Regras do jogo que vai usar a tabela
+   * @param error Motivo da recusa, se houver
+   * @return false se o arquivo não existe, está corrompido, é de outro formato ou de outras
+   *         regras
+   */
+  bool load(const std::string& path, const GameRules& rules, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error = "could not open the file";
+      return false;
+    }
+    struct stat st;
+    auto size = fstat(fd, &st) == 0 ? size_t(st.st_size) : 0;
+    void* p = size >= sizeof(PolicyFileHeader)
+                ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)
+                : MAP_FAILED;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      error = size < sizeof(PolicyFileHeader) ? "not a policy file" : "could not map the file";
+      return false;
+    }
+    std::shared_ptr<const void> map(p, [size](const void* q) {
+      munmap(const_cast<void*>(q), size);
+    });
+
+    const auto& h = *static_cast<const PolicyFileHeader*>(p);
+    PolicyFileHeader expected{};
+    if (not describe(rules, expected, error)) {
+      return false;
+    }
+    if (h.magic != magic_value) {
+      error = "not a policy file";
+      return false;
+    }
+    if (h.version != version_value) {
+      error = "policy file version " + std::to_string(h.version) + " is not supported (expected "
+              + std::to_string(version_value) + "; retrain it with ztrain)";
+      return false;
+    }
+    if (h.header_size != sizeof(PolicyFileHeader) or h.entry_size != sizeof(PolicyEntry)
+        or h.cells != cells
+        or not std::equal(h.levels, h.levels + 7, expected.levels)) {
+      error = "policy table layout differs from this build";
+      return false;
+    }
+    if (size != h.header_size + cells * sizeof(PolicyEntry)) {
+      error = "truncated policy file";
+      return false;
+    }
+    if (h.dice_per_roll != expected.dice_per_roll or h.shots_to_bust != expected.shots_to_bust) {
+      error = "policy was built for " + std::to_string(h.dice_per_roll) + " dice per roll and "
+              + std::to_string(h.shots_to_bust) + " shots to bust, this game uses "
+              + std::to_string(expected.dice_per_roll) + " and "
+              + std::to_string(expected.shots_to_bust);
+      return false;
+    }
+    auto file_rules = rules_of(h);
+    if (file_rules.canonical() != rules.canonical() or h.rules_hash != rules.hash()) {
+      error = "policy was built for rules \"" + file_rules.canonical()
+              + "\", but the configuration has \"" + rules.canonical() + "\"";
+      return false;
+    }
+    auto table = reinterpret_cast<const PolicyEntry*>(static_cast<const char*>(p) + h.header_size);
+    if (checksum(table) != h.checksum) {
+      error = "policy checksum mismatch (corrupted file)";
+      return false;
+    }
+
+    built_for = file_rules;
+    owned.clear();
+    owned.shrink_to_fit();
+    mapping = std::move(map);
+    entries = table;
+    return true;
+  }
+
+  /// @brief Política utilizável pelo simulador e pelo jogo (compartilha a tabela)
+  static Policy as_policy(std::shared_ptr<const PolicyTable> table) {
+    return [table](const TurnView& v) { return table->hold(v); };
+  }
+
+private:
+  static constexpr uint32_t magic_value = 0x5a44504c;  // "ZDPL"
+  static constexpr uint32_t version_value = 2;
+
+  GameRules built_for;
+  std::vector<PolicyEntry> owned;
+  std::shared_ptr<const void> mapping;
+  const PolicyEntry* entries{ nullptr };
+
+  /// @brief Preenche o cabeçalho com as regras e o formato; false (e o motivo) se não couberem
+  static bool describe(const GameRules& rules, PolicyFileHeader& h, std::string& error) {
+    h.magic = magic_value;
+    h.version = version_value;
+    h.header_size = sizeof(PolicyFileHeader);
+    h.entry_size = sizeof(PolicyEntry);
+    h.cells = cells;
+    h.rules_hash = rules.hash();
+    h.brains_to_win = uint32_t(rules.brains_to_win);
+    h.dice_per_roll = TurnModel::dice_per_roll;
+    h.shots_to_bust = TurnModel::shots_to_bust;
+    const size_t levels[]{ hand_levels, shot_levels,   need_levels, margin_levels,
+                           tie_levels,  player_levels, bag_levels };
+    std::copy(levels, levels + 7, h.levels);
+    if (rules.dice_and_faces.size() > 3) {
+      error = "policy files hold at most 3 kinds of dice";
+      return false;
+    }
+    h.dice_kinds = uint32_t(rules.dice_and_faces.size());
+    for (size_t i = 0; i < rules.dice_and_faces.size(); ++i) {
+      const auto& [type, count, faces] = rules.dice_and_faces[i];
+      if (faces.size() >= sizeof(h.dice[i].faces)) {
+        auto limit = sizeof(h.dice[i].faces) - 1;
+        error = "face string \"" + faces + "\" has " + std::to_string(faces.size())
+                + " faces, policy files hold at most " + std::to_string(limit);
+        return false;
+      }
+      h.dice[i].type = uint32_t(type);
+      h.dice[i].count = uint32_t(count);
+      std::memcpy(h.dice[i].faces, faces.data(), faces.size());
+    }
+    return true;
+  }
+
+  /// @brief Regras registradas em um cabeçalho
+  static GameRules rules_of(const PolicyFileHeader& h) {
+    GameRules r;
+    r.brains_to_win = h.brains_to_win;
+    r.dice_and_faces.clear();
+    for (size_t i = 0; i < std::min<size_t>(h.dice_kinds, 3); ++i) {
+      const auto& d = h.dice[i];
+      r.dice_and_faces.push_back({ static_cast<DieType>(d.type % 3), d.count,
+                                   std::string(d.faces, strnlen(d.faces, sizeof(d.faces))) });
+    }
+    return r;
+  }
+
+  static uint64_t checksum(const PolicyEntry* table) {
+    uint64_t h = 14695981039346656037ULL;
+    auto bytes = reinterpret_cast<const unsigned char*>(table);
+    for (size_t i = 0; i < cells * sizeof(PolicyEntry); i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, sizeof(word));
+      h = (h ^ word) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  static bool write_all(int fd, const void* data, size_t size) {
+    auto p = static_cast<const char*>(data);
+    while (size > 0) {
+      auto n = ::write(fd, p, size);
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      size -= size_t(n);
+    }
+    return true;
+  }
+};
+
+#endif  // POLICY_HPP
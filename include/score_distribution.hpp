@@ -0,0 +1,271 @@
+/**
+ * @file score_distribution.hpp
+ * @brief Distribuição exata dos cérebros guardados em um turno, sob uma política de turno
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo calcula, sem amostragem, a probabilidade de cada quantidade de cérebros que
+ * um turno guarda quando o jogador segue uma política fixa (por exemplo, "parar com 4
+ * cérebros ou com 2 tiros"). Levar 3 tiros (`ssa` > 2) conta como 0 cérebros.
+ *
+ * A distribuição de um estado é o polinômio gerador P(x) = Σ p_k x^k dos cérebros
+ * guardados: parar em um estado com `h` cérebros na mão é x^h, e rolar é a mistura das
+ * distribuições dos estados seguintes, enumerados por `TurnModel` com as mesmas regras de
+ * `ROLLING`/`PARSING_DICE` (dados do fim de `dra`, devolução de `bsa` quando restam menos de
+ * 3 dados). Cada estado canônico é resolvido uma única vez e memoizado, e os turnos
+ * seguintes (ou outras mãos iniciais) só consultam a tabela.
+ *
+ * A distribuição é exata enquanto os cérebros não voltam ao saco. Quando voltam, a forma
+ * canônica ignora a ordem da mão, e o resultado é uma aproximação (ver
+ * `TurnState::canonical()`); com os 13 dados das regras padrão o erro fica abaixo de 1e-15.
+ */
+
+#ifndef SCORE_DISTRIBUTION_HPP
+#define SCORE_DISTRIBUTION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "turn_model.hpp"
+
+/// @brief Política de um turno: retorna true para parar no estado informado
+using TurnPolicy = std::function<bool(const TurnState&)>;
+
+/**
+ * @brief Política de limiar do turno: para com `brains` cérebros na mão ou `shots` tiros
+ *
+ * Como as demais políticas de turno, só depende do estado do turno (não do placar), então
+ * pode ser usada com `ScoreDistribution`.
+ */
+inline TurnPolicy hold_at(size_t brains, size_t shots = TurnModel::shots_to_bust) {
+  return [brains, shots](const TurnState& s) {
+    return s.hand.size() >= brains or s.shots >= shots;
+  };
+}
+
+/**
+ * @brief Cria uma política de turno a partir de sua descrição textual
+ * @param spec "t<N>" ou "t<N>s<M>", lida por `parse_threshold()` como em `make_policy()`
+ * @return Política vazia se a descrição for inválida
+ */
+inline TurnPolicy make_turn_policy(const std::string& spec) {
+  size_t brains = 0, shots = 0;
+  return parse_threshold(spec, brains, shots) ? hold_at(brains, shots) : TurnPolicy{};
+}
+
+/**
+ * @class ScoreDistribution
+ * @brief Distribuição exata dos cérebros guardados em um turno, com memoização por estado
+ */
+class ScoreDistribution {
+public:
+  /**
+   * @brief Prepara o cálculo para uma configuração de dados e uma política
+   * @param dice_and_faces Tipos, quantidades e faces dos dados
+   * @param policy Política seguida no turno (deve depender apenas do estado canônico)
+   */
+  ScoreDistribution(const DiceConfig& dice_and_faces, TurnPolicy policy)
+    : model{ dice_and_faces }, policy{ std::move(policy) } {
+    for (const auto& [type, count, faces] : dice_and_faces) {
+      fresh.pool[type] = static_cast<uint8_t>(fresh.pool[type] + count);
+      max_brains += count;
+    }
+    for (size_t k = 0; k <= max_brains; ++k) {
+      held.emplace_back(max_brains + 1, 0.0);
+      held.back()[k] = 1;
+    }
+  }
+
+  /// @brief Estado do início de um turno (todos os dados no saco)
+  const TurnState& start() const { return fresh; }
+
+  /**
+   * @brief Distribuição dos cérebros guardados a partir de `s`
+   * @return p[k] = probabilidade de o turno guardar k cérebros (0 a total de dados)
+   */
+  const std::vector<double>& of(const TurnState& s) {
+    auto c = s.canonical();
+    cyclic.clear();
+    solve(c);
+    if (not cyclic.empty()) {
+      settle();
+    }
+    return solve(c);
+  }
+
+  /// @brief Distribuição de um turno completo (`of(start())`)
+  const std::vector<double>& turn() { return of(fresh); }
+
+  /// @brief Estados resolvidos até agora
+  size_t states() const { return memo.size(); }
+
+  /**
+   * @brief Varreduras feitas para resolver ciclos longos
+   *
+   * Quando restam menos de 3 dados, os cérebros da mão voltam ao saco e o turno pode
+   * reencontrar um estado que ainda está sendo resolvido. Os estados desses ciclos formam um
+   * sistema linear, resolvido por Gauss-Seidel até que nenhuma probabilidade mude mais que
+   * `tolerance`.
+   */
+  size_t cycle_sweeps() const { return sweeps; }
+
+  /// @brief Valor esperado de uma distribuição
+  static double mean(const std::vector<double>& p) {
+    double m = 0;
+    for (size_t k = 0; k < p.size(); ++k) {
+      m += k * p[k];
+    }
+    return m;
+  }
+
+private:
+  static constexpr double tolerance = 1e-13;
+
+  TurnModel model;
+  TurnPolicy policy;
+  TurnState fresh;
+  size_t max_brains{ 0 };
+  std::vector<std::vector<double>> held;  ///< Distribuições de parar com k cérebros
+  /// @brief Estado resolvido (`tainted`: depende de uma estimativa de ciclo longo)
+  struct Entry {
+    std::vector<double> p;
+    bool tainted{ false };
+  };
+
+  std::unordered_map<TurnKey, Entry, TurnKeyHash> memo;
+  std::vector<TurnState> cyclic;  ///< Estados da chamada atual que dependem de um ciclo
+  bool last_tainted{ false };     ///< O último `solve()` dependeu de um ciclo
+  size_t sweeps{ 0 };
+
+  /// @brief Distribuição de um estado canônico
+  const std::vector<double>& solve(const TurnState& s) {
+    auto hand = std::min(s.hand.size(), max_brains);
+    last_tainted = false;
+    if (policy(s)) {
+      return held[hand];
+    }
+    if (not model.can_roll(s)) {
+      // Rolar sem 3 dados encerra o turno sem pontos (ver `Simulator::decide()`).
+      return held[0];
+    }
+    auto [it, inserted] = memo.try_emplace(s.key());
+    if (not inserted) {
+      if (it->second.p.empty()) {
+        // Ainda em resolução: parar serve de estimativa inicial, corrigida por `settle()`.
+        last_tainted = true;
+        return held[hand];
+      }
+      last_tainted = it->second.tainted;
+      return it->second.p;
+    }
+
+    // Rolagens só de pegadas podem voltar ao mesmo estado: P = A + p_self * P.
+    std::vector<double> p(max_brains + 1, 0.0);
+    double self = 0;
+    bool depends = false;
+    model.roll(
+      s,
+      [&](double q, const TurnState& next, bool bust) {
+        if (bust) {
+          p[0] += q;
+          return;
+        }
+        if (next.shots == s.shots and next.pool == s.pool and next.tail == s.tail
+            and next.hand == s.hand) {
+          self += q;
+          return;
+        }
+        const auto& d = solve(next);
+        depends = depends or last_tainted;
+        for (size_t k = 0; k < p.size(); ++k) {
+          p[k] += q * d[k];
+        }
+      },
+      true);
+    if (self > 0) {
+      for (auto& x : p) {
+        x = self < 1 ? x / (1 - self) : 0;
+      }
+    }
+    // `it` continua válido: a tabela só ganha elementos, e unordered_map não move os nós.
+    it->second.p = std::move(p);
+    it->second.tainted = depends;
+    if (depends) {
+      cyclic.push_back(s);
+    }
+    last_tainted = depends;
+    return it->second.p;
+  }
+
+  /// @brief Resolve o sistema linear dos estados em `cyclic` (Gauss-Seidel)
+  void settle() {
+    struct Row {
+      std::vector<double>* p;
+      std::vector<double> base;
+      std::vector<std::pair<size_t, double>> edges;
+      double scale{ 1 };
+    };
+    std::unordered_map<TurnKey, size_t, TurnKeyHash> index;
+    for (size_t i = 0; i < cyclic.size(); ++i) {
+      index[cyclic[i].key()] = i;
+    }
+
+    std::vector<Row> rows(cyclic.size());
+    for (size_t i = 0; i < cyclic.size(); ++i) {
+      const auto& s = cyclic[i];
+      auto& row = rows[i];
+      row.p = &memo[s.key()].p;
+      row.base.assign(max_brains + 1, 0.0);
+      double self = 0;
+      model.roll(
+        s,
+        [&](double q, const TurnState& next, bool bust) {
+          if (bust) {
+            row.base[0] += q;
+            return;
+          }
+          if (next.shots == s.shots and next.pool == s.pool and next.tail == s.tail
+              and next.hand == s.hand) {
+            self += q;
+            return;
+          }
+          auto j = index.find(next.key());
+          if (j != index.end()) {
+            row.edges.push_back({ j->second, q });
+            return;
+          }
+          const auto& d = solve(next);
+          for (size_t k = 0; k < row.base.size(); ++k) {
+            row.base[k] += q * d[k];
+          }
+        },
+        true);
+      row.scale = self < 1 ? 1 / (1 - self) : 0;
+    }
+
+    for (double change = 1; change >= tolerance; ++sweeps) {
+      change = 0;
+      for (auto& row : rows) {
+        for (size_t k = 0; k <= max_brains; ++k) {
+          double x = row.base[k];
+          for (const auto& [j, q] : row.edges) {
+            x += q * (*rows[j].p)[k];
+          }
+          x *= row.scale;
+          change = std::max(change, std::abs(x - (*row.p)[k]));
+          (*row.p)[k] = x;
+        }
+      }
+    }
+    for (const auto& s : cyclic) {
+      memo[s.key()].tainted = false;
+    }
+  }
+};
+
+#endif  // SCORE_DISTRIBUTION_HPP
@@ -0,0 +1,548 @@
+/**
+ * @file simulator.hpp
+ * @brief Motor de simulação sem interface do Zombie Dice
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo implementa uma versão sem entrada/saída das regras de
+ * `GameController::update()`, para simular grandes quantidades de partidas entre robôs:
+ * - mesma ordem dos dados no saco e mesma ordem de consumo do gerador aleatório
+ * - mesma devolução de `bsa` para `dra` quando restam menos de 3 dados
+ * - mesmo critério de desempate (`PARSING_TIE`), incluindo a ordem de eliminação
+ *
+ * Cada partida é determinada pela semente informada, então as simulações podem ser
+ * divididas entre processos e repetidas exatamente.
+ */
+
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game_event.hpp"
+#include "game_rules.hpp"
+#include "game_snapshot.hpp"
+#include "turn_model.hpp"
+
+/**
+ * @struct SimDie
+ * @brief Dado compacto do simulador (tipo + face atual)
+ */
+struct SimDie {
+  DieType type;
+  char face{ 0 };
+};
+
+/**
+ * @struct TurnView
+ * @brief O que um robô enxerga ao decidir entre rolar e parar (`START`/`SHOW_SCOREBOARD`)
+ *
+ * @var TurnView::turn Conteúdo dos sacos do ponto de vista do jogador
+ * @var TurnView::seat Posição original do jogador na mesa
+ * @var TurnView::banked Cérebros já guardados pelo jogador
+ * @var TurnView::best_opponent Maior pontuação entre os outros jogadores
+ * @var TurnView::players Jogadores ainda na partida
+ * @var TurnView::brains_to_win Cérebros necessários para vencer
+ * @var TurnView::tie Indica se a partida está no desempate
+ */
+struct TurnView {
+  TurnState turn;
+  size_t seat{ 0 };
+  size_t banked{ 0 };
+  size_t best_opponent{ 0 };
+  size_t players{ 0 };
+  size_t brains_to_win{ 13 };
+  bool tie{ false };
+};
+
+/// @brief Política de um robô: retorna true para parar (hold) e false para rolar
+using Policy = std::function<bool(const TurnView&)>;
+
+/**
+ * @brief Política de limiar: para com `brains` cérebros na mão ou `shots` tiros
+ *
+ * Também para sempre que os cérebros da mão já garantem `brains_to_win` e a liderança
+ * (no desempate, empatar de novo não basta).
+ */
+inline Policy threshold_policy(size_t brains, size_t shots = TurnModel::shots_to_bust) {
+  return [brains, shots](const TurnView& v) {
+    auto hand = v.turn.hand.size();
+    auto total = v.banked + hand;
+    return hand >= brains or v.turn.shots >= shots
+           or (total >= v.brains_to_win and total > v.best_opponent);
+  };
+}
+
+/**
+ * @brief Cria uma política a partir de sua descrição textual
+ * @param spec "t<N>" (limiar de cérebros) ou "t<N>s<M>" (limiar de cérebros e de tiros)
+ * @return Política vazia se a descrição for inválida
+ */
+inline Policy make_policy(const std::string& spec) {
+  size_t brains = 0, shots = 0;
+  return parse_threshold(spec, brains, shots) ? threshold_policy(brains, shots) : Policy{};
+}
+
+/**
+ * @struct GameResult
+ * @brief Resultado de uma partida simulada
+ *
+ * @var GameResult::finished Falso se a partida foi interrompida pelo limite de turnos
+ * @var GameResult::winner Posição do vencedor na mesa (-1 se não terminou)
+ * @var GameResult::first Posição do jogador sorteado para começar
+ * @var GameResult::rounds Turnos jogados pelo vencedor
+ * @var GameResult::turns Turnos jogados por todos os jogadores
+ * @var GameResult::tie_break Indica se houve desempate
+ * @var GameResult::brains Cérebros de cada posição ao final
+ * @var GameResult::busts Turnos perdidos por 3+ tiros, por posição
+ * @var GameResult::seat_turns Turnos jogados por posição
+ */
+struct GameResult {
+  static constexpr size_t max_seats = 8;
+
+  bool finished{ false };
+  int winner{ -1 };
+  size_t first{ 0 };
+  size_t rounds{ 0 };
+  size_t turns{ 0 };
+  bool tie_break{ false };
+  std::array<uint32_t, max_seats> brains{};
+  std::array<uint32_t, max_seats> busts{};
+  std::array<uint32_t, max_seats> seat_turns{};
+};
+
+/**
+ * @struct SimStats
+ * @brief Estatísticas acumuladas de várias partidas (somáveis em qualquer ordem)
+ *
+ * Estrutura POD de tamanho fixo, gravada diretamente nos arquivos de checkpoint.
+ */
+struct SimStats {
+  static constexpr size_t max_seats = GameResult::max_seats;
+
+  uint64_t games{ 0 };
+  uint64_t unfinished{ 0 };
+  uint64_t tie_breaks{ 0 };
+  uint64_t first_wins{ 0 };
+  uint64_t rounds{ 0 };
+  uint64_t turns{ 0 };
+  std::array<uint64_t, max_seats> wins{};
+  std::array<uint64_t, max_seats> busts{};
+  std::array<uint64_t, max_seats> seat_turns{};
+  std::array<uint64_t, max_seats> brains{};
+
+  /// @brief Soma o resultado de uma partida
+  void add(const GameResult& r) {
+    games++;
+    if (not r.finished) {
+      unfinished++;
+    } else {
+      wins[r.winner]++;
+      first_wins += size_t(r.winner) == r.first;
+      rounds += r.rounds;
+    }
+    tie_breaks += r.tie_break;
+    turns += r.turns;
+    for (size_t i = 0; i < max_seats; ++i) {
+      busts[i] += r.busts[i];
+      seat_turns[i] += r.seat_turns[i];
+      brains[i] += r.brains[i];
+    }
+  }
+
+  /// @brief Soma as estatísticas de outro lote de partidas
+  void merge(const SimStats& o) {
+    games += o.games;
+    unfinished += o.unfinished;
+    tie_breaks += o.tie_breaks;
+    first_wins += o.first_wins;
+    rounds += o.rounds;
+    turns += o.turns;
+    for (size_t i = 0; i < max_seats; ++i) {
+      wins[i] += o.wins[i];
+      busts[i] += o.busts[i];
+      seat_turns[i] += o.seat_turns[i];
+      brains[i] += o.brains[i];
+    }
+  }
+};
+
+/**
+ * @brief Semente da partida `game` de uma campanha (splitmix64)
+ *
+ * Não depende de como a campanha é dividida, então qualquer divisão em lotes produz
+ * exatamente as mesmas partidas.
+ */
+inline uint64_t game_seed(uint64_t base, uint64_t game) {
+  uint64_t z = base + (game + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @class Simulator
+ * @brief Executa partidas com as regras de `GameController::update()`, sem E/S
+ *
+ * Uso passo a passo (para robôs externos):
+ * 1. `start()` sorteia o jogador inicial e prepara o saco
+ * 2. enquanto `not over()`: `view()` descreve a decisão e `decide()` a aplica
+ *
+ * Ou, para políticas locais, simplesmente `play()`.
+ */
+class Simulator {
+public:
+  static constexpr size_t max_turns = 10000;  ///< Limite de segurança por partida
+
+  /// @brief Prepara o simulador para as regras informadas
+  explicit Simulator(const GameRules& rules) : brains_to_win{ rules.brains_to_win } {
+    for (const auto& [type, count, faces] : rules.dice_and_faces) {
+      dice_and_faces.push_back({ type, count });
+      this->faces[type] = faces;
+    }
+    auto total = rules.total_dice();
+    dra.reserve(total);
+    bsa.reserve(total);
+    ssa.reserve(total);
+  }
+
+  /// @brief Semeia o gerador com os 64 bits da semente
+  static void seed_rng(std::mt19937& rng, uint64_t seed) { seed_engine(rng, seed); }
+
+  /**
+   * @brief Inicia uma nova partida (`INIT_PLAYER` + `INIT`)
+   * @param count Número de jogadores (2 a GameResult::max_seats)
+   * @param seed Semente da partida
+   */
+  void start(size_t count, uint64_t seed) {
+    seed_rng(rng, seed);
+    players.clear();
+    removed.clear();
+    for (size_t i = 0; i < count; ++i) {
+      players.push_back({ i });
+    }
+    tie = false;
+    tie_break = false;
+    finished = false;
+    total_turns = 0;
+    bsa.clear();
+    ssa.clear();
+    choose_first();
+    first = players[idx].seat;
+    init_bag();
+  }
+
+  /// @brief Indica se a partida terminou
+  bool over() const { return finished or total_turns >= max_turns; }
+
+  /// @brief Posição na mesa do jogador da vez
+  size_t seat() const { return players[idx].seat; }
+
+  /// @brief Posição na mesa do jogador de índice `active` entre os ativos (`GameEvent::player`)
+  size_t seat_of(size_t active) const { return players[active].seat; }
+
+  /// @brief Decisão pendente do jogador da vez
+  TurnView view() const {
+    TurnView v;
+    v.turn = TurnState::from_bags(dra, bsa, ssa);
+    v.seat = players[idx].seat;
+    v.banked = players[idx].brains;
+    for (size_t i = 0; i < players.size(); ++i) {
+      if (i != size_t(idx)) {
+        v.best_opponent = std::max(v.best_opponent, players[i].brains);
+      }
+    }
+    v.players = players.size();
+    v.brains_to_win = brains_to_win;
+    v.tie = tie;
+    return v;
+  }
+
+  /**
+   * @brief Aplica a decisão do jogador da vez (`HOLDING` ou `ROLLING` + `PARSING_DICE`)
+   * @param hold true para parar, false para rolar
+   */
+  void decide(bool hold) {
+    if (hold) {
+      players[idx].brains += bsa.size();
+      notify(HOLD);
+      adding_turn();
+      return;
+    }
+
+    if (dra.size() < 3) {
+      dra.insert(dra.end(), bsa.begin(), bsa.end());
+      bsa.clear();
+    }
+    if (dra.size() < 3) {
+      // Saco vazio mesmo com a devolução: o turno termina sem pontos (como em `ROLLING`).
+      adding_turn();
+      return;
+    }
+
+    std::array<SimDie, 3> rolled;
+    for (size_t i = 0; i < 3; ++i) {
+      auto& d = dra[dra.size() - 1 - i];
+      const auto& f = faces[d.type];
+      d.face = f[std::uniform_int_distribution<int>(0, f.size() - 1)(rng)];
+      rolled[i] = d;
+    }
+    dra.resize(dra.size() - 3);
+
+    for (const auto& d : rolled) {
+      if (d.face == BRAIN) {
+        bsa.push_back(d);
+      } else if (d.face == SHOT) {
+        ssa.push_back(d);
+      } else {
+        dra.push_back(d);
+      }
+    }
+
+    if (observer) {
+      GameEvent e = event(ROLL);
+      for (size_t i = 0; i < 3; ++i) {
+        e.types[i] = rolled[i].type;
+        e.faces[i] = rolled[i].face;
+      }
+      observer(e);
+    }
+
+    if (ssa.size() > 2) {
+      players[idx].busts++;
+      notify(BUST);
+      adding_turn();
+    }
+  }
+
+  /// @brief Resultado da partida (parcial, se ainda não terminou)
+  GameResult result() const {
+    GameResult r;
+    r.finished = finished;
+    r.turns = total_turns;
+    r.tie_break = tie_break;
+    r.first = first;
+    if (finished) {
+      r.winner = static_cast<int>(players[0].seat);
+      r.rounds = players[0].turns;
+    }
+    for (const auto* group : { &players, &removed }) {
+      for (const auto& p : *group) {
+        r.brains[p.seat] = p.brains;
+        r.busts[p.seat] = p.busts;
+        r.seat_turns[p.seat] = p.turns;
+      }
+    }
+    return r;
+  }
+
+  /**
+   * @brief Joga uma partida completa
+   * @param lineup Política de cada posição da mesa
+   * @param seed Semente da partida
+   */
+  GameResult play(const std::vector<Policy>& lineup, uint64_t seed) {
+    start(lineup.size(), seed);
+    while (not over()) {
+      decide(lineup[players[idx].seat](view()));
+    }
+    return result();
+  }
+
+  /// @brief Gerador aleatório da partida (mesma sequência de consumo do jogo)
+  std::mt19937& engine() { return rng; }
+
+  /**
+   * @brief Retrato da partida (o gerador aleatório não é incluído)
+   *
+   * Sempre cabe: o simulador tem até `GameResult::max_seats` jogadores e regras jogáveis
+   * (`GameRules::playable()`), com menos dados que `GameSnapshot::max_dice`.
+   */
+  GameSnapshot snapshot() const {
+    GameSnapshot s;
+    s.idx = static_cast<uint8_t>(idx);
+    s.first = static_cast<uint8_t>(first);
+    s.flags = (tie ? GameSnapshot::TIE : 0) | (tie_break ? GameSnapshot::TIE_BREAK : 0)
+              | (finished ? GameSnapshot::FINISHED : 0);
+    s.active = static_cast<uint8_t>(players.size());
+    s.removed = static_cast<uint8_t>(removed.size());
+    auto out = s.players;
+    for (const auto* group : { &players, &removed }) {
+      for (const auto& p : *group) {
+        *out++ = { static_cast<uint16_t>(p.brains), static_cast<uint16_t>(p.turns),
+                   static_cast<uint8_t>(std::min<size_t>(p.busts, 255)), 0, 0,
+                   static_cast<uint8_t>(p.seat) };
+      }
+    }
+    bool stored = true;
+    for (const auto& d : dra) {
+      stored = s.push_die(GameSnapshot::DRA, d.type, d.face) and stored;
+    }
+    for (const auto& d : bsa) {
+      stored = s.push_die(GameSnapshot::BSA, d.type, d.face) and stored;
+    }
+    for (const auto& d : ssa) {
+      stored = s.push_die(GameSnapshot::SSA, d.type, d.face) and stored;
+    }
+    assert(stored);
+    return s;
+  }
+
+  /**
+   * @brief Continua a partida a partir de um retrato
+   *
+   * O gerador não é alterado: semeie `engine()` para escolher o futuro da partida.
+   */
+  void restore(const GameSnapshot& s) {
+    idx = s.idx;
+    first = s.first;
+    tie = (s.flags & GameSnapshot::TIE) != 0;
+    tie_break = (s.flags & GameSnapshot::TIE_BREAK) != 0;
+    finished = (s.flags & GameSnapshot::FINISHED) != 0;
+    players.clear();
+    removed.clear();
+    total_turns = 0;
+    for (size_t i = 0; i < size_t(s.active + s.removed); ++i) {
+      const auto& p = s.players[i];
+      (i < s.active ? players : removed).push_back({ p.seat(), p.brains, p.turns, p.busts });
+      total_turns += p.turns;
+    }
+    dra.clear();
+    bsa.clear();
+    ssa.clear();
+    for (size_t i = 0; i < s.dice_count(); ++i) {
+      auto& area = i < s.segments[0] ? dra : i < size_t(s.segments[0] + s.segments[1]) ? bsa : ssa;
+      area.push_back({ static_cast<DieType>(s.die_type(i)), s.die_face(i) });
+    }
+  }
+
+  /// @brief Dados em `ssa` (tiros do turno), na ordem em que foram recebidos
+  const std::vector<SimDie>& shots() const { return ssa; }
+
+  /// @brief Recebe os eventos das próximas partidas (vazio para desligar)
+  void observe(GameObserver o) { observer = std::move(o); }
+
+private:
+  /// @brief Jogador simulado
+  struct SimPlayer {
+    size_t seat;
+    size_t brains{ 0 };
+    size_t turns{ 0 };
+    size_t busts{ 0 };
+  };
+
+  std::vector<std::pair<DieType, size_t>> dice_and_faces;
+  std::array<std::string, 3> faces;
+  size_t brains_to_win;
+
+  std::mt19937 rng;
+  std::vector<SimDie> dra, bsa, ssa;
+  std::vector<SimPlayer> players, removed;
+  int idx{ 0 };
+  size_t first{ 0 };
+  bool tie{ false };
+  bool tie_break{ false };
+  bool finished{ false };
+  size_t total_turns{ 0 };
+  GameObserver observer;
+
+  /// @brief Evento do jogador da vez, com os dados em jogo
+  GameEvent event(GameEventKind kind) const {
+    GameEvent e;
+    e.kind = kind;
+    e.player = static_cast<uint8_t>(idx);
+    e.dice = static_cast<uint8_t>(dra.size() + bsa.size() + ssa.size());
+    e.value = static_cast<uint32_t>(players[idx].brains);
+    return e;
+  }
+
+  void notify(GameEventKind kind) const {
+    if (observer) {
+      observer(event(kind));
+    }
+  }
+
+  /// @brief `INIT_PLAYER`: sorteia quem começa
+  void choose_first() {
+    idx = std::uniform_int_distribution<int>(0, players.size() - 1)(rng);
+    if (observer) {
+      GameEvent e;
+      e.player = static_cast<uint8_t>(idx);
+      observer(e);
+    }
+  }
+
+  /// @brief `DiceBag::init()`: recria e embaralha o saco
+  void init_bag() {
+    dra.clear();
+    for (const auto& [type, count] : dice_and_faces) {
+      dra.insert(dra.end(), count, SimDie{ type });
+    }
+    std::shuffle(dra.begin(), dra.end(), rng);
+  }
+
+  /// @brief `ADDING_TURN` → `PREPARING` → `CLEANING` → `INIT`
+  void adding_turn() {
+    players[idx].turns++;
+    total_turns++;
+
+    auto turn = std::all_of(players.begin(), players.end(), [&](const auto& p) {
+      return p.turns == players[0].turns;
+    });
+    auto btw = std::any_of(players.begin(), players.end(), [&](const auto& p) {
+      return p.brains >= brains_to_win;
+    });
+    if (turn and btw) {
+      parsing_tie();
+      return;
+    }
+
+    idx = idx + 1 == int(players.size()) ? 0 : idx + 1;
+    bsa.clear();
+    ssa.clear();
+    init_bag();
+  }
+
+  /// @brief `PARSING_TIE` → `INIT_TIE` → `INIT_PLAYER` → `INIT`
+  void parsing_tie() {
+    auto max = std::max_element(players.begin(), players.end(), [](auto& p1, auto& p2) {
+                 return p1.brains < p2.brains;
+               })->brains;
+
+    // Mesma varredura do jogo: após remover o jogador i, o seguinte não é verificado.
+    for (size_t i = 0; i < players.size(); i++) {
+      if (players[i].brains < (tie ? max : brains_to_win)) {
+        removed.push_back(players[i]);
+        players.erase(players.begin() + i);
+      }
+    }
+
+    bsa.clear();
+    ssa.clear();
+    if (observer) {
+      GameEvent e;
+      e.kind = players.size() > 1 ? TIE : GAME_END;
+      e.value = static_cast<uint32_t>(players.size());
+      observer(e);
+    }
+    if (players.size() > 1) {
+      init_bag();
+      tie = true;
+      tie_break = true;
+      choose_first();
+      init_bag();
+    } else {
+      finished = true;
+    }
+  }
+};
+
+#endif  // SIMULATOR_HPP
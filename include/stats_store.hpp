@@ -0,0 +1,674 @@
+/**
+ * @file stats_store.hpp
+ * @brief Estatísticas persistentes dos jogadores entre sessões
+ * @copyright Copyright (c) 2024
+ * @license MIT License
+ *
+ * Este arquivo implementa um armazenamento em disco, mapeado em memória, das estatísticas
+ * acumuladas de cada jogador. São usados três arquivos:
+ * - `<path>`: cabeçalho + registros de tamanho fixo (somente anexados, nunca removidos)
+ * - `<path>.idx`: índice hash nome → registro (reconstruído se estiver inconsistente)
+ * - `<path>.log`: diário das partidas ainda não aplicadas aos registros
+ *
+ * Cada partida é primeiro gravada no diário (com fsync) e só depois aplicada aos registros.
+ * Cada registro guarda a sequência da última partida aplicada, então repetir o diário após
+ * uma queda é idempotente.
+ *
+ * Vários processos (jogos e `zstats`) podem manter o armazenamento aberto ao mesmo tempo:
+ * cada gravação toma um `flock` exclusivo do arquivo de registros só durante a partida
+ * gravada, e cada consulta toma um `flock` compartilhado. Depois de obter o bloqueio, o
+ * processo refaz os mapeamentos se outro processo aumentou os arquivos.
+ */
+
+#ifndef STATS_STORE_HPP
+#define STATS_STORE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @struct PlayerRecord
+ * @brief Registro de tamanho fixo com as estatísticas de um jogador
+ *
+ * @var PlayerRecord::name Nome do jogador (truncado em 31 bytes)
+ * @var PlayerRecord::hash Hash FNV-1a do nome completo
+ * @var PlayerRecord::last_seq Sequência da última partida aplicada ao registro
+ * @var PlayerRecord::games Partidas jogadas até o fim
+ * @var PlayerRecord::wins Vitórias
+ * @var PlayerRecord::tie_breaks Partidas em que chegou ao desempate
+ * @var PlayerRecord::busts Turnos perdidos por 3+ tiros (FORCE_QUIT)
+ * @var PlayerRecord::turns Turnos jogados
+ * @var PlayerRecord::brains Cérebros acumulados
+ * @var PlayerRecord::longest_streak Maior sequência de turnos seguidos sem levar 3 tiros
+ */
+struct PlayerRecord {
+  char name[32];
+  uint64_t hash;
+  uint64_t last_seq;
+  uint32_t games;
+  uint32_t wins;
+  uint32_t tie_breaks;
+  uint32_t busts;
+  uint32_t turns;
+  uint32_t brains;
+  uint32_t longest_streak;
+  uint32_t reserved;
+
+  /// @brief Média de cérebros por turno
+  double brains_per_turn() const { return turns == 0 ? 0.0 : double(brains) / turns; }
+};
+
+static_assert(sizeof(PlayerRecord) == 80, "PlayerRecord must keep its on-disk layout");
+
+/**
+ * @struct GameStats
+ * @brief Resultado de um jogador em uma partida, a ser somado ao seu registro
+ */
+struct GameStats {
+  std::string name;
+  bool won{ false };
+  bool tie_break{ false };
+  uint32_t busts{ 0 };
+  uint32_t turns{ 0 };
+  uint32_t brains{ 0 };
+  uint32_t longest_streak{ 0 };
+};
+
+/**
+ * @class StatsStore
+ * @brief Armazenamento persistente de estatísticas dos jogadores
+ */
+class StatsStore {
+public:
+  /// @brief Função de ordenação/percentil: extrai uma métrica de um registro
+  using Metric = std::function<double(const PlayerRecord&)>;
+
+  StatsStore() = default;
+  StatsStore(const StatsStore&) = delete;
+  StatsStore& operator=(const StatsStore&) = delete;
+  ~StatsStore() { close(); }
+
+  /**
+   * @brief Abre (ou cria) o armazenamento e repete o diário pendente
+   * @param path Caminho do arquivo de registros
+   * @return false se algum dos arquivos não puder ser aberto ou o diário não puder ser repetido
+   */
+  bool open(const std::string& path) {
+    close();
+    base = path;
+    data_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (data_fd < 0) {
+      return false;
+    }
+    bool ok = false;
+    {
+      // O bloqueio é liberado antes de `close()`, que fecha o descritor.
+      FileLock lock(data_fd, LOCK_EX);
+      ok = attach();
+    }
+    if (not ok) {
+      close();
+    }
+    return ok;
+  }
+
+  /// @brief Sincroniza e libera os mapeamentos
+  void close() {
+    if (header != nullptr) {
+      msync(header, mapped_size(capacity), MS_SYNC);
+      munmap(header, mapped_size(capacity));
+      header = nullptr;
+    }
+    if (index != nullptr) {
+      munmap(index_header(), index_bytes(index_capacity));
+      index = nullptr;
+    }
+    if (data_fd >= 0) {
+      ::close(data_fd);
+      data_fd = -1;
+    }
+    if (index_fd >= 0) {
+      ::close(index_fd);
+      index_fd = -1;
+    }
+  }
+
+  /// @brief Indica se o armazenamento está aberto
+  bool is_open() const { return header != nullptr; }
+
+  /// @brief Número de jogadores registrados
+  size_t size() {
+    if (header == nullptr) {
+      return 0;
+    }
+    FileLock lock(data_fd, LOCK_SH);
+    return sync(false) ? header->count : 0;
+  }
+
+  /**
+   * @brief Busca O(1) de um jogador pelo nome
+   * @return Cópia do registro, vazia se o jogador nunca jogou
+   */
+  std::optional<PlayerRecord> find(std::string_view name) {
+    if (header == nullptr) {
+      return std::nullopt;
+    }
+    FileLock lock(data_fd, LOCK_SH);
+    if (not sync(false)) {
+      return std::nullopt;
+    }
+    auto r = locate(name);
+    return r == nullptr ? std::nullopt : std::optional<PlayerRecord>{ *r };
+  }
+
+  /**
+   * @brief Registra o resultado de uma partida para todos os participantes
+   *
+   * 1. Anexa a partida ao diário e faz fsync
+   * 2. Aplica os valores aos registros (criando os jogadores novos)
+   * 3. Sincroniza os registros e descarta o diário
+   *
+   * @return false se a partida não pôde ser gravada no diário (nada é aplicado) ou se os
+   *         registros não puderam crescer (ela fica no diário e é aplicada depois)
+   */
+  bool record_game(const std::vector<GameStats>& game) {
+    if (header == nullptr) {
+      return false;
+    }
+    FileLock lock(data_fd, LOCK_EX);
+    if (not sync(true)) {
+      return false;
+    }
+    // Partidas de um processo que caiu antes de aplicá-las (e que ocupam os próximos `seq`).
+    if (not replay_log()) {
+      return false;
+    }
+    auto seq = header->applied_seq + 1;
+
+    std::string entry;
+    put(entry, seq);
+    put(entry, static_cast<uint64_t>(game.size()));
+    for (const auto& g : game) {
+      put(entry, static_cast<uint64_t>(g.name.size()));
+      entry.append(g.name);
+      uint32_t values[]{ g.won, g.tie_break, g.busts, g.turns, g.brains, g.longest_streak };
+      entry.append(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    put(entry, hash_name(entry));
+
+    int log_fd = ::open(log_path().c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log_fd < 0) {
+      return false;
+    }
+    struct stat st;
+    fstat(log_fd, &st);
+    auto length = static_cast<uint64_t>(entry.size());
+    auto ok = write(log_fd, &length, sizeof(length)) == sizeof(length)
+              and write(log_fd, entry.data(), entry.size()) == ssize_t(entry.size())
+              and fsync(log_fd) == 0;
+    if (not ok) {
+      // Remove a entrada incompleta para não bloquear a repetição das seguintes.
+      ftruncate(log_fd, st.st_size);
+    }
+    ::close(log_fd);
+    if (not ok) {
+      return false;
+    }
+
+    if (not apply(seq, game)) {
+      return false;  // a partida está no diário: quem gravar em seguida a aplica
+    }
+    checkpoint(seq);
+    return true;
+  }
+
+  /**
+   * @brief Os `n` melhores jogadores segundo uma métrica
+   * @return Cópias dos registros, do maior para o menor valor
+   */
+  std::vector<PlayerRecord> top(size_t n, const Metric& metric) {
+    if (header == nullptr) {
+      return {};
+    }
+    FileLock lock(data_fd, LOCK_SH);
+    if (not sync(false)) {
+      return {};
+    }
+    std::vector<std::pair<double, uint32_t>> keys(header->count);
+    for (uint32_t i = 0; i < keys.size(); ++i) {
+      keys[i] = { metric(records()[i]), i };
+    }
+    n = std::min(n, keys.size());
+    std::partial_sort(keys.begin(), keys.begin() + n, keys.end(), [](auto& a, auto& b) {
+      return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    std::vector<PlayerRecord> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      result.push_back(records()[keys[i].second]);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Percentil de um jogador segundo uma métrica
+   * @return Porcentagem de jogadores com valor estritamente menor (0 a 100), ou -1
+   */
+  double percentile_rank(std::string_view name, const Metric& metric) {
+    if (header == nullptr) {
+      return -1;
+    }
+    FileLock lock(data_fd, LOCK_SH);
+    auto r = sync(false) ? locate(name) : nullptr;
+    if (r == nullptr) {
+      return -1;
+    }
+    auto value = metric(*r);
+    size_t below = 0;
+    for (size_t i = 0; i < header->count; ++i) {
+      below += metric(records()[i]) < value;
+    }
+    return 100.0 * below / header->count;
+  }
+
+  /// @brief Hash FNV-1a de 64 bits
+  static uint64_t hash_name(std::string_view name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+      h = (h ^ c) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+private:
+  static constexpr uint32_t magic_value = 0x5a445354;  // "ZDST"
+  static constexpr uint32_t version_value = 1;
+  static constexpr uint64_t initial_capacity = 1024;
+
+  /// @brief Cabeçalho do arquivo de registros (ocupa o espaço de um registro)
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t applied_seq;
+    char padding[sizeof(PlayerRecord) - 32];
+  };
+
+  /// @brief Cabeçalho do arquivo de índice
+  struct IndexHeader {
+    uint64_t magic;
+    uint64_t count;
+    uint64_t capacity;
+    uint64_t reserved;
+  };
+
+  static_assert(sizeof(Header) == sizeof(PlayerRecord), "header must fill one record slot");
+
+  /// @brief `flock` mantido enquanto o objeto existir
+  struct FileLock {
+    int fd;
+    FileLock(int fd, int operation) : fd{ fd } { flock(fd, operation); }
+    ~FileLock() { flock(fd, LOCK_UN); }
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+  };
+
+  Header* header{ nullptr };
+  uint32_t* index{ nullptr };
+  uint64_t capacity{ 0 };
+  uint64_t index_capacity{ 0 };
+  int data_fd{ -1 };
+  int index_fd{ -1 };
+  bool index_valid{ false };  ///< O índice corresponde aos registros (senão, busca linear)
+  std::string base;
+
+  std::string log_path() const { return base + ".log"; }
+  std::string index_path() const { return base + ".idx"; }
+
+  static size_t mapped_size(uint64_t records) { return (records + 1) * sizeof(PlayerRecord); }
+  static size_t index_bytes(uint64_t slots) { return sizeof(IndexHeader) + slots * 4; }
+
+  PlayerRecord* records() const { return reinterpret_cast<PlayerRecord*>(header + 1); }
+  IndexHeader* index_header() const { return reinterpret_cast<IndexHeader*>(index) - 1; }
+
+  /// @brief Cria o cabeçalho se preciso, mapeia os arquivos e repete o diário (com o bloqueio)
+  bool attach() {
+    struct stat st;
+    fstat(data_fd, &st);
+    if (st.st_size < static_cast<off_t>(sizeof(Header))) {
+      Header h{};
+      h.magic = magic_value;
+      h.version = version_value;
+      h.record_size = sizeof(PlayerRecord);
+      if (pwrite(data_fd, &h, sizeof(h), 0) != sizeof(h)) {
+        return false;
+      }
+    }
+    if (not map_records(initial_capacity)) {
+      return false;
+    }
+    if (header->magic != magic_value or header->version != version_value
+        or header->record_size != sizeof(PlayerRecord)) {
+      return false;
+    }
+    return load_index() and replay_log();
+  }
+
+  template <typename T>
+  static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  /**
+   * @brief Acompanha as mudanças feitas por outros processos (com o bloqueio obtido)
+   *
+   * Refaz o mapeamento dos registros se o arquivo cresceu e o do índice se ele foi
+   * reconstruído. Um índice inconsistente só é reconstruído por quem grava (`exclusive`);
+   * as consultas passam a buscar linearmente.
+   */
+  bool sync(bool exclusive) {
+    struct stat st;
+    fstat(data_fd, &st);
+    if (static_cast<size_t>(st.st_size) != mapped_size(capacity) and not map_records(0)) {
+      return false;
+    }
+    return exclusive ? load_index() : (check_index(), true);
+  }
+
+  /**
+   * @brief (Re)mapeia o arquivo de registros inteiro, aumentando-o para `records` registros
+   * @return false se não foi possível; o mapeamento anterior continua válido
+   */
+  bool map_records(uint64_t records) {
+    struct stat st;
+    fstat(data_fd, &st);
+    if (static_cast<size_t>(st.st_size) < mapped_size(records)) {
+      if (ftruncate(data_fd, mapped_size(records)) != 0) {
+        return false;
+      }
+    } else {
+      records = st.st_size / sizeof(PlayerRecord) - 1;
+    }
+    void* p = mmap(nullptr, mapped_size(records), PROT_READ | PROT_WRITE, MAP_SHARED, data_fd, 0);
+    if (p == MAP_FAILED) {
+      return false;
+    }
+    if (header != nullptr) {
+      munmap(header, mapped_size(capacity));
+    }
+    header = static_cast<Header*>(p);
+    capacity = records;
+    return true;
+  }
+
+  /// @brief (Re)mapeia o arquivo de índice com `slots` posições (potência de 2)
+  bool map_index(uint64_t slots, bool reset) {
+    if (index != nullptr) {
+      munmap(index_header(), index_bytes(index_capacity));
+      index = nullptr;
+    }
+    if (index_fd < 0) {
+      index_fd = ::open(index_path().c_str(), O_RDWR | O_CREAT, 0644);
+      if (index_fd < 0) {
+        return false;
+      }
+    }
+    if (reset and ftruncate(index_fd, 0) != 0) {
+      return false;
+    }
+    if (ftruncate(index_fd, index_bytes(slots)) != 0) {
+      return false;
+    }
+    void* p = mmap(nullptr, index_bytes(slots), PROT_READ | PROT_WRITE, MAP_SHARED, index_fd, 0);
+    if (p == MAP_FAILED) {
+      return false;
+    }
+    index = reinterpret_cast<uint32_t*>(static_cast<IndexHeader*>(p) + 1);
+    index_capacity = slots;
+    return true;
+  }
+
+  /**
+   * @brief Verifica o índice gravado e o mapeia se ele corresponder aos registros
+   * @return Capacidade do índice, ou 0 se ele estiver inconsistente
+   */
+  uint64_t check_index() {
+    index_valid = false;
+    if (index_fd < 0) {
+      index_fd = ::open(index_path().c_str(), O_RDWR | O_CREAT, 0644);
+      if (index_fd < 0) {
+        return 0;
+      }
+    }
+    IndexHeader ih{};
+    pread(index_fd, &ih, sizeof(ih), 0);
+
+    struct stat st;
+    fstat(index_fd, &st);
+    bool valid = ih.magic == magic_value and ih.count == header->count and ih.capacity != 0
+                 and (ih.capacity & (ih.capacity - 1)) == 0
+                 and static_cast<size_t>(st.st_size) == index_bytes(ih.capacity);
+    if (not valid) {
+      return 0;
+    }
+    if (index == nullptr or index_capacity != ih.capacity) {
+      // Mapeia sem mudar o tamanho: o arquivo já tem `index_bytes(ih.capacity)` bytes.
+      if (not map_index(ih.capacity, false)) {
+        return 0;
+      }
+    }
+    index_valid = true;
+    return ih.capacity;
+  }
+
+  /// @brief Abre o índice; reconstrói se não corresponder aos registros
+  bool load_index() {
+    if (check_index() != 0) {
+      return true;
+    }
+    return index_fd >= 0
+           and rebuild_index(std::max<uint64_t>(2 * initial_capacity, 4 * header->count));
+  }
+
+  bool rebuild_index(uint64_t slots) {
+    uint64_t pow2 = 1;
+    while (pow2 < slots) {
+      pow2 <<= 1;
+    }
+    if (not map_index(pow2, true)) {
+      return false;
+    }
+    auto* ih = index_header();
+    ih->magic = magic_value;
+    ih->capacity = pow2;
+    for (uint64_t i = 0; i < header->count; ++i) {
+      const auto& r = records()[i];
+      index[probe(r.name, r.hash)] = static_cast<uint32_t>(i + 1);
+    }
+    ih->count = header->count;
+    index_valid = true;
+    return true;
+  }
+
+  /// @brief Registro de um jogador pelo índice (ou busca linear, se ele estiver inconsistente)
+  const PlayerRecord* locate(std::string_view name) const {
+    auto hash = hash_name(name);
+    if (index_valid) {
+      auto slot = probe(name, hash);
+      return index[slot] == 0 ? nullptr : &records()[index[slot] - 1];
+    }
+    auto truncated = name.substr(0, sizeof(PlayerRecord::name) - 1);
+    for (size_t i = 0; i < header->count; ++i) {
+      if (records()[i].hash == hash and truncated == records()[i].name) {
+        return &records()[i];
+      }
+    }
+    return nullptr;
+  }
+
+  /// @brief Sondagem linear: posição do nome no índice, ou a primeira posição livre
+  size_t probe(std::string_view name, uint64_t hash) const {
+    auto mask = index_capacity - 1;
+    auto truncated = name.substr(0, sizeof(PlayerRecord::name) - 1);
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+      if (index[slot] == 0) {
+        return slot;
+      }
+      const auto& r = records()[index[slot] - 1];
+      if (r.hash == hash and truncated == r.name) {
+        return slot;
+      }
+    }
+  }
+
+  /**
+   * @brief Busca ou cria o registro de um jogador
+   * @return nullptr se o arquivo ou o índice não puderam crescer
+   */
+  PlayerRecord* lookup_or_insert(const std::string& name) {
+    auto hash = hash_name(name);
+    auto slot = probe(name, hash);
+    if (index[slot] != 0) {
+      return &records()[index[slot] - 1];
+    }
+
+    if (header->count == capacity and not map_records(2 * capacity)) {
+      return nullptr;
+    }
+    auto& r = records()[header->count];
+    std::memset(&r, 0, sizeof(r));
+    std::strncpy(r.name, name.c_str(), sizeof(r.name) - 1);
+    r.hash = hash;
+    header->count++;
+
+    if (2 * header->count > index_capacity) {
+      if (not rebuild_index(2 * index_capacity)) {
+        // O registro já existe; o próximo `load_index()` tenta reconstruir o índice de novo.
+        index_valid = false;
+        return nullptr;
+      }
+    } else {
+      index[slot] = static_cast<uint32_t>(header->count);
+      index_header()->count = header->count;
+    }
+    return &r;
+  }
+
+  /// @return false se algum registro não pôde ser criado (a partida fica no diário)
+  bool apply(uint64_t seq, const std::vector<GameStats>& game) {
+    for (const auto& g : game) {
+      auto* record = lookup_or_insert(g.name);
+      if (record == nullptr) {
+        return false;
+      }
+      auto& r = *record;
+      if (r.last_seq >= seq) {
+        continue;
+      }
+      r.games++;
+      r.wins += g.won;
+      r.tie_breaks += g.tie_break;
+      r.busts += g.busts;
+      r.turns += g.turns;
+      r.brains += g.brains;
+      r.longest_streak = std::max(r.longest_streak, g.longest_streak);
+      r.last_seq = seq;
+    }
+    return true;
+  }
+
+  /// @brief Torna os registros duráveis e descarta o diário já aplicado
+  void checkpoint(uint64_t seq) {
+    msync(header, mapped_size(capacity), MS_SYNC);
+    header->applied_seq = seq;
+    msync(header, sizeof(Header), MS_SYNC);
+    truncate(log_path().c_str(), 0);
+  }
+
+  /**
+   * @brief Reaplica as partidas do diário que não chegaram aos registros
+   * @return false se alguma não pôde ser aplicada (o diário é mantido)
+   */
+  bool replay_log() {
+    int log_fd = ::open(log_path().c_str(), O_RDONLY);
+    if (log_fd < 0) {
+      return true;
+    }
+    std::string content;
+    char buffer[4096];
+    for (ssize_t n; (n = read(log_fd, buffer, sizeof(buffer))) > 0;) {
+      content.append(buffer, n);
+    }
+    ::close(log_fd);
+
+    uint64_t last = 0;
+    for (size_t pos = 0; pos + 8 <= content.size();) {
+      uint64_t length;
+      std::memcpy(&length, content.data() + pos, 8);
+      if (length < 24 or pos + 8 + length > content.size()) {
+        break;  // entrada incompleta: a queda ocorreu durante a escrita
+      }
+      std::string_view entry{ content.data() + pos + 8, length };
+      pos += 8 + length;
+
+      uint64_t checksum;
+      std::memcpy(&checksum, entry.data() + entry.size() - 8, 8);
+      if (checksum != hash_name(entry.substr(0, entry.size() - 8))) {
+        break;
+      }
+
+      std::vector<GameStats> game;
+      uint64_t seq, count;
+      size_t at = 16;
+      std::memcpy(&seq, entry.data(), 8);
+      std::memcpy(&count, entry.data() + 8, 8);
+      for (uint64_t i = 0; i < count; ++i) {
+        uint64_t name_size;
+        std::memcpy(&name_size, entry.data() + at, 8);
+        GameStats g;
+        g.name = std::string{ entry.substr(at + 8, name_size) };
+        at += 8 + name_size;
+        uint32_t values[6];
+        std::memcpy(values, entry.data() + at, sizeof(values));
+        at += sizeof(values);
+        g.won = values[0];
+        g.tie_break = values[1];
+        g.busts = values[2];
+        g.turns = values[3];
+        g.brains = values[4];
+        g.longest_streak = values[5];
+        game.push_back(std::move(g));
+      }
+      if (seq > header->applied_seq) {
+        if (not apply(seq, game)) {
+          return false;
+        }
+        last = seq;
+      }
+    }
+    if (last != 0) {
+      checkpoint(last);
+    } else {
+      truncate(log_path().c_str(), 0);
+    }
+    return true;
+  }
+};
+
+#endif  // STATS_STORE_HPP
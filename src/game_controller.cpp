@@ -10,11 +10,7 @@ DiceBag GameController::dra;
 DiceBag GameController::bsa;
 DiceBag GameController::ssa;
 
-std::unordered_map<std::string, std::pair<size_t, bool>> dm_menber{
-  { "weak_dice", { 0, true } },   { "weak_die_faces", { 0, false } },
-  { "tough_dice", { 1, true } },  { "tough_die_faces", { 1, false } },
-  { "strong_dice", { 2, true } }, { "strong_die_faces", { 2, false } },
-};
+GameObserver GameController::observer;
 
 // Auxiliar function:
 std::string trim(const std::string& t_line) {
@@ -49,6 +45,10 @@ std::string get_color(char c) {
   }
 }
 
+std::string box_line(const std::string& text) {
+  return "│" + text + std::string(text.size() < 40 ? 40 - text.size() : 0, ' ') + "│";
+}
+
 // Auxiliar members:
 auto idx{ 0 };
 char input;
@@ -56,6 +56,15 @@ bool tie{ false };
 std::string size;
 std::vector<ZDie> actual_dice;
 std::vector<Player> removed_players;
+std::unique_ptr<FrameBroadcaster> broadcaster;
+StatsStore stats;
+std::unique_ptr<OddsCalculator> odds;
+std::shared_ptr<const PolicyTable> bot_policy;
+bool quiet{ false };
+std::ofstream decision_log;
+std::string save_file{ "zdice.save" };
+std::string save_message;
+int resume_state{ 0 };
 
 std::string GameController::welcome_message() {
   std::string message = R"(
@@ -81,38 +90,54 @@ void GameController::parse_config(int argc, char** argv) {
 
   if (argc == 2) {
     IniParser parser(argv[1]);
-    auto btw = parser.get_map().find("brains_to_win");
-
-    if (btw != parser.get_map().end()) {
-
-      bool isdigit = std::all_of(
-        btw->second.begin(), btw->second.end(), [](char c) { return std::isdigit(c); });
-
-      if (isdigit) {
-        brains_to_win = std::stoi(btw->second);
+    GameRules rules;
+    rules.load(parser);
+    dra.dice_and_faces = rules.dice_and_faces;
+    brains_to_win = rules.brains_to_win;
+
+    auto policy_file = parser.get("bot_policy");
+    if (not policy_file.empty()) {
+      auto table = std::make_shared<PolicyTable>();
+      std::string error;
+      if (table->load(policy_file, rules, error)) {
+        bot_policy = table;
+      } else {
+        std::cerr << "Could not load bot policy \"" << policy_file << "\": " << error << ".\n";
       }
     }
 
-    for (const auto& p : parser.get_map()) {
-      auto it = dm_menber.find(p.first);
-      if (it != dm_menber.end()) {
-        if (it->second.second) {
+    if (not parser.get("save_file").empty()) {
+      save_file = parser.get("save_file");
+    }
+    auto saved_game = parser.get("load_game");
+    if (not saved_game.empty() and not load_game(saved_game)) {
+      std::cerr << "Could not resume the game saved in \"" << saved_game << "\".\n";
+      exit(1);
+    }
 
-          bool isdigit
-            = std::all_of(p.second.begin(), p.second.end(), [](char c) { return std::isdigit(c); });
-          if (isdigit) {
-            std::get<1>(dra.dice_and_faces[it->second.first]) = std::stoi(p.second);
-          }
-        } else {
+    auto log_file = parser.get("decision_log");
+    std::string error;
+    if (not log_file.empty() and not current_rules().playable(error)) {
+      // The turn views of the log only hold DieSeq::capacity dice.
+      std::cerr << "Decision log disabled: " << error << ".\n";
+    } else if (not log_file.empty()) {
+      decision_log.open(log_file, std::ios::app);
+      if (not decision_log) {
+        std::cerr << "Could not open decision log \"" << log_file << "\".\n";
+      }
+    }
 
-          bool isvalid = std::all_of(p.second.begin(), p.second.end(), [](char c) {
-            return c == 'b' or c == 'f' or c == 's';
-          });
+    auto stats_file = parser.get("stats_file");
+    if (not stats_file.empty() and not stats.open(stats_file)) {
+      std::cerr << "Could not open stats file \"" << stats_file << "\".\n";
+    }
 
-          if (isvalid) {
-            std::get<2>(dra.dice_and_faces[it->second.first]) = p.second;
-          }
-        }
+    auto channel = parser.get("broadcast_channel");
+    if (not channel.empty()) {
+      broadcaster = std::make_unique<FrameBroadcaster>(channel);
+      if (not broadcaster->is_open()) {
+        std::cerr << "Could not open broadcast channel \"" << channel << "\".\n";
+        broadcaster.reset();
       }
     }
   } else if (argc > 2) {
@@ -134,11 +159,20 @@ void GameController::process_events() {
   case SHOW_DICE:
   case FORCE_QUIT:
   case INIT_TIE:
-    std::cin.get();
+    if (not quiet) {
+      std::cin.get();
+    }
     break;
   case START:
   case SHOW_SCOREBOARD:
-    std::cin.get(input);
+    if (players[idx].bot) {
+      input = players[idx].bot(turn_view()) ? 'h' : '\n';
+      if (not quiet) {
+        std::cout << (input == 'h' ? "h" : "<Enter>") << " (bot)\n";
+      }
+    } else {
+      std::cin.get(input);
+    }
     break;
   default:
     break;
@@ -146,6 +180,7 @@ void GameController::process_events() {
 };
 
 void GameController::update() {
+  auto previous = state;
   switch (state) {
   case BEGIN:
     state = WELCOME_MESSAGE;
@@ -185,10 +220,9 @@ void GameController::update() {
     break;
 
   case INIT_PLAYER: {
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<int> distrib(0, players.size() - 1);
-    idx = distrib(gen);
+    idx = distrib(dice_engine());
+    prepare_odds();
     state = INIT;
     break;
   }
@@ -234,8 +268,12 @@ void GameController::update() {
       state = INIT_TIE;
       dra.init();
       tie = true;
+      for (auto& p : players) {
+        p.tie_break = true;
+      }
     } else {
       state = END;
+      record_stats();
     }
     actual_dice.clear();
     bsa.get_dice().clear();
@@ -253,18 +291,39 @@ void GameController::update() {
 
     switch (input) {
     case '\n':
+      log_decision(false);
       state = ROLLING;
       break;
     case 'h':
+      log_decision(true);
       state = HOLDING;
       break;
     case 'q':
       state = QUIT;
       break;
+    case 's':
+      state = state == SHOW_SCOREBOARD ? SHOW_SCOREBOARD : START;
+      resume_state = state;
+      if (not GameSnapshot::fits(players.size() + removed_players.size(),
+                                 current_rules().total_dice())) {
+        save_message = ">>> Games with more than " + std::to_string(GameSnapshot::max_players)
+                       + " players or " + std::to_string(GameSnapshot::max_dice)
+                       + " dice cannot be saved.\n";
+      } else {
+        save_message = save_game(save_file) ? ">>> Game saved to \"" + save_file + "\".\n"
+                                            : ">>> Could not save to \"" + save_file + "\"!\n";
+      }
+      state = SAVING;
+      break;
     default:
       state = INVALID_OPTION;
     }
 
+    break;
+  case SAVING:
+    std::cin.ignore();
+  case RESUMING:
+    state = static_cast<State>(resume_state);
     break;
   case ROLLING:
 
@@ -272,6 +331,11 @@ void GameController::update() {
       dra.get_dice().insert(dra.get_dice().end(), bsa.get_dice().begin(), bsa.get_dice().end());
       bsa.get_dice().clear();
     }
+    if (dra.get_dice().size() < 3) {
+      // Saco vazio mesmo com a devolução: o turno termina sem pontos (ver `Simulator::decide()`).
+      state = ADDING_TURN;
+      break;
+    }
 
     for (auto rit{ dra.get_dice().rbegin() }; rit != dra.get_dice().rbegin() + 3; rit++) {
       rit->roll();
@@ -284,8 +348,11 @@ void GameController::update() {
     break;
   case HOLDING:
 
-    std::cin.ignore();
+    if (not players[idx].bot) {
+      std::cin.ignore();
+    }
     players[idx].brains += bsa.get_dice().size();
+    players[idx].longest_streak = std::max(players[idx].longest_streak, ++players[idx].streak);
     state = ADDING_TURN;
 
     break;
@@ -317,14 +384,27 @@ void GameController::update() {
 
     break;
   case FORCE_QUIT:
+    players[idx].busts++;
+    players[idx].streak = 0;
     state = ADDING_TURN;
     break;
   default:
     break;
   }
+
+  if (broadcaster) {
+    const char event[]{ static_cast<char>(state), static_cast<char>(idx) };
+    broadcaster->publish({ event, sizeof(event) }, EVENT);
+  }
+  if (observer) {
+    notify(previous);
+  }
 };
 
 void GameController::render() {
+  if (quiet) {
+    return;
+  }
   std::ostringstream oss;
   switch (state) {
   case WELCOME_MESSAGE:
@@ -346,6 +426,9 @@ void GameController::render() {
   case INVALID_OPTION:
     oss << ">>> Invalid option! Try again:\n";
     break;
+  case SAVING:
+    oss << save_message;
+    break;
   case QUIT:
   case END:
   case START:
@@ -359,7 +442,12 @@ void GameController::render() {
   default:
     break;
   }
-  std::cout << oss.str();
+  auto frame = oss.str();
+  std::cout << frame;
+  if (broadcaster and not frame.empty()) {
+    auto key = state == START or state == INIT_TIE or state == QUIT or state == END;
+    broadcaster->publish(frame, key ? KEYFRAME : FRAME);
+  }
   oss.clear();
 }
 
@@ -396,6 +484,25 @@ void GameController::read_players() {
     if (vec.empty())
       continue;
 
+    auto bot = std::find_if(vec.begin(), vec.end(), [&](const auto& n) {
+      return n[0] == '@' and not make_bot(n, vec.size());
+    });
+    std::string error;
+    if (bot != vec.end() and not current_rules().playable(error)) {
+      std::cout << ">>> Robôs não jogam com esta configuração (" << error << ").\n";
+      continue;
+    }
+    if (bot != vec.end() and *bot == "@mcts") {
+      std::cout << ">>> @mcts joga em partidas de até " << GameSnapshot::max_players
+                << " jogadores e " << GameSnapshot::max_dice << " dados.\n";
+      continue;
+    }
+    if (bot != vec.end()) {
+      std::cout << ">>> Robô inválido \"" << *bot << "\". Use @t<N>, @t<N>s<M>, @mcts"
+                << (bot_policy ? " ou @policy" : "") << ".\n";
+      continue;
+    }
+
     if (vec.size() != players.capacity()) {
       std::cout << ">>> Você deve digitar exatamente " << players.capacity()
                 << " nomes. Foi encontrado " << vec.size() << " nome(s).\n";
@@ -407,9 +514,52 @@ void GameController::read_players() {
 
   for (const auto& n : vec) {
     players.push_back(n);
+    players.back().bot = make_bot(n, vec.size());
+    auto record = stats.find(n);
+    if (record) {
+      std::cout << ">>> Welcome back, " << n << "! " << record->wins << " win(s) in "
+                << record->games << " game(s).\n";
+    }
   }
 }
 
+void GameController::record_stats() {
+  if (not stats.is_open()) {
+    return;
+  }
+  std::vector<GameStats> game;
+  for (const auto* group : { &players, &removed_players }) {
+    for (const auto& p : *group) {
+      GameStats g;
+      g.name = p.name;
+      g.won = group == &players;
+      g.tie_break = p.tie_break;
+      g.busts = p.busts;
+      g.turns = p.turns;
+      g.brains = p.brains;
+      g.longest_streak = p.longest_streak;
+      game.push_back(g);
+    }
+  }
+  if (not stats.record_game(game)) {
+    std::cerr << "Could not record the game in the stats file.\n";
+  }
+}
+
+void GameController::log_decision(bool hold) {
+  if (not decision_log.is_open()) {
+    return;
+  }
+  auto v = turn_view();
+  DecisionRecord r;
+  r.player = players[idx].name;
+  r.turn = v.turn;
+  r.banked = v.banked;
+  r.best_opponent = v.best_opponent;
+  r.hold = hold;
+  decision_log << r.str() << '\n';
+}
+
 std::string GameController::global_score() {
   std::ostringstream oss;
 
@@ -506,7 +656,9 @@ std::string GameController::message_area() {
     oss << "│ Ready to play?                         │\n"
         << "│   <enter> - roll dices                 │\n"
         << "│   H + <enter> - hold turn              │\n"
+        << "│   S + <enter> - save game              │\n"
         << "│   Q + <enter> - quit game              │";
+    oss << odds_panel();
     break;
   case SHOW_DICE: {
     auto b{ 0 }, s{ 0 };
@@ -580,4 +732,325 @@ std::string GameController::message_area() {
   oss << "\n└────────────────────────────────────────┘\n🧟>";
   return oss.str();
 }
+void GameController::prepare_odds() {
+  size_t total{ 0 };
+  TurnState full;
+  for (const auto& [type, count, faces] : dra.dice_and_faces) {
+    total += count;
+    full.pool[type] = static_cast<uint8_t>(count);
+  }
+  if (odds or total > DieSeq::capacity) {
+    return;
+  }
+  odds = std::make_unique<OddsCalculator>(dra.dice_and_faces, brains_to_win);
+  odds->odds(full, brains_to_win);
+}
+
+std::string GameController::odds_panel() {
+  if (not odds) {
+    return "";
+  }
+  auto s = TurnState::from_bags(dra.get_dice(), bsa.get_dice(), ssa.get_dice());
+  auto banked = players[idx].brains;
+  auto o = odds->odds(s, brains_to_win > banked ? brains_to_win - banked : 0);
+
+  std::ostringstream bust, roll, reach;
+  bust << std::fixed << std::setprecision(1) << "   bust on next roll: " << 100 * o.bust << "%";
+  roll << std::fixed << std::setprecision(2) << "   brains if you roll: " << o.roll_brains
+       << " (hold: " << size_t(o.hold_brains) << ")";
+  reach << std::fixed << std::setprecision(1) << "   reach " << brains_to_win
+        << " brains this turn: " << 100 * o.reach << "%";
+
+  return "\n" + box_line(" Odds:") + "\n" + box_line(bust.str()) + "\n" + box_line(roll.str())
+         + "\n" + box_line(reach.str());
+}
+
+GameRules GameController::current_rules() {
+  GameRules rules;
+  rules.dice_and_faces = dra.dice_and_faces;
+  rules.brains_to_win = brains_to_win;
+  return rules;
+}
+
+Policy GameController::make_bot(const std::string& name, size_t seats) {
+  // Os robôs decidem sobre `TurnState`, que só cabe em regras jogáveis.
+  std::string error;
+  if (name.size() < 2 or name[0] != '@' or not current_rules().playable(error)) {
+    return {};
+  }
+  auto spec = name.substr(1);
+  if (spec == "policy") {
+    return bot_policy ? PolicyTable::as_policy(bot_policy) : Policy{};
+  }
+  if (spec == "mcts") {
+    // O robô busca a partir do retrato da partida, que precisa caber em um GameSnapshot.
+    if (not GameSnapshot::fits(seats, current_rules().total_dice())) {
+      return {};
+    }
+    return MctsBot::as_policy(std::make_shared<MctsBot>(current_rules()), [] {
+      GameSnapshot s;
+      snapshot(s);
+      return s;
+    });
+  }
+  return make_policy(spec);
+}
+
+TurnView GameController::turn_view() {
+  TurnView v;
+  v.turn = TurnState::from_bags(dra.get_dice(), bsa.get_dice(), ssa.get_dice());
+  v.seat = idx;
+  v.banked = players[idx].brains;
+  for (size_t i = 0; i < players.size(); ++i) {
+    if (i != size_t(idx)) {
+      v.best_opponent = std::max(v.best_opponent, players[i].brains);
+    }
+  }
+  v.players = players.size();
+  v.brains_to_win = brains_to_win;
+  v.tie = tie;
+  return v;
+}
+
+void GameController::notify(State previous) {
+  GameEvent e;
+  e.player = static_cast<uint8_t>(idx);
+  e.dice = static_cast<uint8_t>(dra.get_dice().size() + bsa.get_dice().size()
+                                + ssa.get_dice().size());
+
+  switch (previous) {
+  case INIT_PLAYER:
+    e = GameEvent{};
+    e.player = static_cast<uint8_t>(idx);
+    break;
+  case ROLLING:
+    if (actual_dice.empty()) {
+      return;  // Nada foi rolado: o saco não tinha 3 dados
+    }
+    e.kind = ROLL;
+    e.dice += static_cast<uint8_t>(actual_dice.size());
+    for (size_t i = 0; i < 3 and i < actual_dice.size(); ++i) {
+      e.types[i] = actual_dice[i].type;
+      e.faces[i] = actual_dice[i].face;
+    }
+    break;
+  case HOLDING:
+    e.kind = HOLD;
+    break;
+  case FORCE_QUIT:
+    e.kind = BUST;
+    break;
+  case PARSING_TIE:
+    e = GameEvent{};
+    e.kind = state == END ? GAME_END : TIE;
+    e.value = static_cast<uint32_t>(players.size());
+    break;
+  default:
+    return;
+  }
+  if (e.kind == ROLL or e.kind == HOLD or e.kind == BUST) {
+    // Only turn events have a current player: after PARSING_TIE `idx` may be past the end.
+    e.value = static_cast<uint32_t>(players[idx].brains);
+  }
+  observer(e);
+}
+
+void GameController::reset(const GameRules& rules, const std::vector<Policy>& bots,
+                           uint64_t seed) {
+  if (dra.dice_and_faces != rules.dice_and_faces or brains_to_win != rules.brains_to_win) {
+    odds.reset();
+  }
+  dra.dice_and_faces = rules.dice_and_faces;
+  brains_to_win = rules.brains_to_win;
+  quiet = true;
+
+  players.clear();
+  removed_players.clear();
+  for (size_t i = 0; i < bots.size(); ++i) {
+    players.push_back("@bot" + std::to_string(i + 1));
+    players.back().bot = bots[i];
+  }
+  dra.get_dice().clear();
+  bsa.get_dice().clear();
+  ssa.get_dice().clear();
+  actual_dice.clear();
+  tie = false;
+  idx = 0;
+  seed_engine(dice_engine(), seed);
+  state = INIT_PLAYER;
+}
+
+bool GameController::snapshot(GameSnapshot& s) {
+  if (not GameSnapshot::fits(players.size() + removed_players.size(),
+                             current_rules().total_dice())) {
+    return false;
+  }
+  s = GameSnapshot{};
+  s.state = static_cast<uint8_t>(state);
+  s.idx = static_cast<uint8_t>(idx);
+  s.flags = tie ? GameSnapshot::TIE | GameSnapshot::TIE_BREAK : 0;
+  s.active = static_cast<uint8_t>(players.size());
+  s.removed = static_cast<uint8_t>(removed_players.size());
+
+  auto out = s.players;
+  uint8_t seat = 0;
+  for (const auto* group : { &players, &removed_players }) {
+    for (const auto& p : *group) {
+      *out++ = { static_cast<uint16_t>(p.brains),
+                 static_cast<uint16_t>(p.turns),
+                 static_cast<uint8_t>(std::min<size_t>(p.busts, 255)),
+                 static_cast<uint8_t>(std::min<size_t>(p.streak, 255)),
+                 static_cast<uint8_t>(std::min<size_t>(p.longest_streak, 255)),
+                 static_cast<uint8_t>(seat++ | (p.tie_break ? 0x10 : 0)) };
+    }
+  }
+
+  bool stored = true;
+  for (const auto& d : dra.get_dice()) {
+    stored = s.push_die(GameSnapshot::DRA, d.type, d.face) and stored;
+  }
+  for (const auto& d : bsa.get_dice()) {
+    stored = s.push_die(GameSnapshot::BSA, d.type, d.face) and stored;
+  }
+  for (const auto& d : ssa.get_dice()) {
+    stored = s.push_die(GameSnapshot::SSA, d.type, d.face) and stored;
+  }
+  for (const auto& d : actual_dice) {
+    stored = s.push_die(GameSnapshot::ROLLED, d.type, d.face) and stored;
+  }
+  return stored;
+}
+
+bool GameController::restore(const GameSnapshot& s, const std::vector<std::string>& names) {
+  std::string faces[3];
+  size_t missing[3]{};
+  for (const auto& [type, count, f] : dra.dice_and_faces) {
+    faces[type] = f;
+    missing[type] += count;
+  }
+  if (names.size() != size_t(s.active + s.removed) or s.active == 0
+      or s.dice_count() > GameSnapshot::max_dice) {
+    return false;
+  }
+  // O retrato deve ter exatamente os dados da configuração, de cada tipo.
+  for (size_t i = 0; i < s.dice_count(); ++i) {
+    auto type = s.die_type(i);
+    if (type > 2 or missing[type] == 0) {
+      return false;
+    }
+    missing[type]--;
+  }
+  if (missing[0] + missing[1] + missing[2] != 0) {
+    return false;
+  }
+
+  players.clear();
+  removed_players.clear();
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto& p = s.players[i];
+    auto& group = i < s.active ? players : removed_players;
+    group.push_back(names[i]);
+    group.back().brains = p.brains;
+    group.back().turns = p.turns;
+    group.back().busts = p.busts;
+    group.back().streak = p.streak;
+    group.back().longest_streak = p.longest_streak;
+    group.back().tie_break = p.tie_break();
+    group.back().bot = make_bot(names[i], names.size());
+  }
+
+  dra.get_dice().clear();
+  bsa.get_dice().clear();
+  ssa.get_dice().clear();
+  actual_dice.clear();
+  std::vector<ZDie>* areas[]{ &dra.get_dice(), &bsa.get_dice(), &ssa.get_dice(), &actual_dice };
+  for (size_t segment = 0, i = 0; segment < 4; ++segment) {
+    for (size_t k = 0; k < s.segments[segment]; ++k, ++i) {
+      ZDie die{ static_cast<DieType>(s.die_type(i)), faces[s.die_type(i) % 3] };
+      die.face = s.die_face(i);
+      areas[segment]->push_back(die);
+    }
+  }
+
+  idx = s.idx;
+  tie = (s.flags & GameSnapshot::TIE) != 0;
+  state = static_cast<State>(s.state);
+  return true;
+}
+
+// Formato: "ZDSV", hash das regras (8 bytes LE), retrato codificado e os nomes
+// (1 byte de tamanho + texto cada).
+bool GameController::save_game(const std::string& path) {
+  GameSnapshot s;
+  if (not snapshot(s)) {
+    return false;
+  }
+  s.state = static_cast<uint8_t>(resume_state);
+
+  auto hash = current_rules().hash();
+
+  std::string data{ "ZDSV" };
+  for (int i = 0; i < 8; ++i) {
+    data += static_cast<char>(hash >> (8 * i));
+  }
+  uint8_t encoded[GameSnapshot::encoded_size];
+  s.encode(encoded);
+  data.append(reinterpret_cast<const char*>(encoded), sizeof(encoded));
+  for (const auto* group : { &players, &removed_players }) {
+    for (const auto& p : *group) {
+      auto name = p.name.substr(0, 255);
+      data += static_cast<char>(name.size());
+      data += name;
+    }
+  }
+
+  std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+  out.write(data.data(), data.size());
+  return bool(out);
+}
+
+bool GameController::load_game(const std::string& path) {
+  std::ifstream in{ path, std::ios::binary };
+  std::string data{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+  if (data.size() < 12 + GameSnapshot::encoded_size or data.compare(0, 4, "ZDSV") != 0) {
+    return false;
+  }
+
+  auto rules = current_rules();
+  uint64_t hash = 0;
+  for (int i = 0; i < 8; ++i) {
+    hash |= uint64_t(static_cast<uint8_t>(data[4 + i])) << (8 * i);
+  }
+  if (hash != rules.hash()) {
+    std::cerr << "The saved game uses different rules.\n";
+    return false;
+  }
+
+  // Entre rolagens nada está na mesa, o turno não estourou e `ROLLING` tem 3 dados para tirar
+  // de `dra` (contando a devolução de `bsa`).
+  GameSnapshot s;
+  if (not s.decode(reinterpret_cast<const uint8_t*>(data.data() + 12))
+      or (s.state != START and s.state != SHOW_SCOREBOARD) or s.segments[GameSnapshot::ROLLED] != 0
+      or s.segments[GameSnapshot::SSA] > 2
+      or s.segments[GameSnapshot::DRA] + s.segments[GameSnapshot::BSA] < 3) {
+    return false;
+  }
+  std::vector<std::string> names;
+  for (size_t pos = 12 + GameSnapshot::encoded_size; pos < data.size();) {
+    size_t len = static_cast<uint8_t>(data[pos]);
+    names.push_back(data.substr(pos + 1, len));
+    pos += 1 + len;
+  }
+  if (not restore(s, names)) {
+    return false;
+  }
+
+  resume_state = state;
+  state = RESUMING;
+  prepare_odds();
+  std::cout << ">>> Resuming the game saved in \"" << path << "\" (" << players.size()
+            << " players).\n";
+  return true;
+}
+
 bool GameController::game_over() { return state == END or state == QUIT; }
@@ -1,3 +1,6 @@
+#ifndef INI_PARSER_CPP
+#define INI_PARSER_CPP
+
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -68,3 +71,5 @@ private:
     return (begin != std::string::npos ? t_line.substr(begin, end - begin + 1) : "");
   }
 };
+
+#endif  // INI_PARSER_CPP
@@ -0,0 +1,480 @@
+/**
+ * @file zanalyze.cpp
+ *
+ * @description
+ * Decision-quality analyzer for recorded games (`decision_log` in the config).
+ *
+ * Every roll/hold decision is scored against the turn-optimal play for the
+ * configured dice and brains_to_win: the value of a turn is the expected
+ * number of brains it banks, counting at most what the player still needs
+ * (brains_to_win, or one more than an opponent who already reached it).
+ * Values are solved exactly by dynamic programming over the canonical states
+ * of TurnModel and memoized per thread, so repeated states cost a lookup.
+ * When brains are returned to an empty bag a turn can come back to a state
+ * that is still being solved; those states are settled together by value
+ * iteration, as ScoreDistribution does for a fixed policy. Those turns are
+ * only approximated: the canonical states ignore the order of the brains in
+ * hand, which decides the next dice rolled after the refill (see
+ * TurnState::canonical(); negligible with the standard 13 dice).
+ *
+ * The log is streamed: a reader hands batches of lines to the worker threads
+ * through a bounded queue, so memory stays constant whatever the input size.
+ * The report lists, per player, the decisions, the errors (the chosen action
+ * is worth less than the other one) and the brains lost, followed by the
+ * costliest mistakes with their line numbers.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread tools/zanalyze.cpp -o zanalyze
+ * Usage: ./zanalyze <config.ini> <decisions|-> [--threads T] [--top K] [--batch N]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/decision_record.hpp"
+#include "../include/game_rules.hpp"
+
+/// Turn-optimal values of both actions, in brains.
+struct ActionValues {
+  double hold{ 0 };
+  double roll{ 0 };
+};
+
+/// Turn-optimal values, memoized by canonical state and need.
+class TurnEvaluator {
+public:
+  explicit TurnEvaluator(const DiceConfig& dice_and_faces) : model{ dice_and_faces } {}
+
+  /// Values of holding and rolling in `s` when `need` more brains win the game.
+  ActionValues evaluate(const TurnState& s, size_t need) {
+    if (memo.size() + decisions.size() > memo_limit) {
+      memo.clear();
+      decisions.clear();
+    }
+    need = std::min<size_t>(need, 255);
+    auto [it, inserted] = decisions.try_emplace(s.key(uint8_t(need)));
+    auto& v = it->second;
+    if (inserted) {
+      v.hold = double(std::min(s.hand.size(), need));
+      // Without 3 dice to roll the turn ends empty-handed (see Simulator::decide()).
+      if (model.can_roll(s)) {
+        cyclic.clear();
+        v.roll = roll(s, need);
+        if (not cyclic.empty()) {
+          settle();
+          v.roll = roll(s, need);
+        }
+      }
+    } else {
+      hits++;
+    }
+    return v;
+  }
+
+  size_t states() const { return memo.size(); }
+  uint64_t cache_hits() const { return hits; }
+
+private:
+  static constexpr size_t memo_limit = 1 << 22;
+  static constexpr double tolerance = 1e-13;
+
+  /// A solved state (`tainted`: depends on the estimate of a state still being solved).
+  struct Entry {
+    double value{ NAN };
+    bool tainted{ false };
+  };
+
+  TurnModel model;
+  std::unordered_map<TurnKey, Entry, TurnKeyHash> memo;
+  std::unordered_map<TurnKey, ActionValues, TurnKeyHash> decisions;
+  std::vector<std::pair<TurnState, size_t>> cyclic;  ///< Tainted states of this evaluation
+  bool last_tainted{ false };                         ///< The last value() was tainted
+  uint64_t hits{ 0 };
+
+  static bool same(const TurnState& a, const TurnState& b) {
+    return a.shots == b.shots and a.pool == b.pool and a.tail == b.tail and a.hand == b.hand;
+  }
+
+  /// Optimal value of a canonical state.
+  double value(const TurnState& s, size_t need) {
+    auto held = double(std::min(s.hand.size(), need));
+    last_tainted = false;
+    if (s.hand.size() >= need or not model.can_roll(s)) {
+      return held;
+    }
+    auto [it, inserted] = memo.try_emplace(s.key(uint8_t(need)));
+    if (not inserted) {
+      // NaN: still being solved (long cycle with an empty bag). Holding is a lower bound,
+      // corrected by settle().
+      last_tainted = std::isnan(it->second.value) or it->second.tainted;
+      return std::isnan(it->second.value) ? held : it->second.value;
+    }
+    bool depends = false;
+    auto v = std::max(held, roll(s, need, &depends));
+    // `it` stays valid: nodes of an unordered_map never move.
+    it->second = { v, depends };
+    if (depends) {
+      cyclic.push_back({ s, need });
+    }
+    last_tainted = depends;
+    return v;
+  }
+
+  /// Expected value of rolling once and then playing optimally.
+  double roll(const TurnState& s, size_t need, bool* depends = nullptr) {
+    auto self_state = s.canonical();
+    double sum = 0, self = 0;
+    model.roll(
+      s,
+      [&](double p, const TurnState& next, bool bust) {
+        if (bust) {
+          return;
+        }
+        // Rolls of footprints only can come back to the same state: v = a + p_self * v.
+        if (same(next, self_state)) {
+          self += p;
+          return;
+        }
+        sum += p * value(next, need);
+        if (depends != nullptr and last_tainted) {
+          *depends = true;
+        }
+      },
+      true);
+    return self < 1 ? sum / (1 - self) : 0;
+  }
+
+  /// Value iteration over the states in `cyclic` (Gauss-Seidel order).
+  void settle() {
+    struct Row {
+      double* value;
+      double held;
+      double base{ 0 };
+      std::vector<std::pair<size_t, double>> edges;
+      double scale{ 1 };
+    };
+    std::unordered_map<TurnKey, size_t, TurnKeyHash> index;
+    for (size_t i = 0; i < cyclic.size(); ++i) {
+      index[cyclic[i].first.key(uint8_t(cyclic[i].second))] = i;
+    }
+
+    std::vector<Row> rows(cyclic.size());
+    for (size_t i = 0; i < cyclic.size(); ++i) {
+      const auto& [s, need] = cyclic[i];
+      auto& row = rows[i];
+      row.value = &memo[s.key(uint8_t(need))].value;
+      row.held = double(std::min(s.hand.size(), need));
+      double self = 0;
+      model.roll(
+        s,
+        [&](double q, const TurnState& next, bool bust) {
+          if (bust) {
+            return;
+          }
+          if (same(next, s)) {
+            self += q;
+            return;
+          }
+          auto j = index.find(next.key(uint8_t(need)));
+          if (j != index.end()) {
+            row.edges.push_back({ j->second, q });
+          } else {
+            row.base += q * value(next, need);
+          }
+        },
+        true);
+      row.scale = self < 1 ? 1 / (1 - self) : 0;
+    }
+
+    for (double change = 1; change >= tolerance;) {
+      change = 0;
+      for (auto& row : rows) {
+        double x = row.base;
+        for (const auto& [j, q] : row.edges) {
+          x += q * *rows[j].value;
+        }
+        x = std::max(row.held, x * row.scale);
+        change = std::max(change, std::abs(x - *row.value));
+        *row.value = x;
+      }
+    }
+    for (const auto& [s, need] : cyclic) {
+      memo[s.key(uint8_t(need))].tainted = false;
+    }
+  }
+};
+
+/// Lines handed to a worker.
+struct Batch {
+  uint64_t first_line{ 0 };
+  std::vector<std::string> lines;
+};
+
+/// A decision worth less than the alternative.
+struct Mistake {
+  double loss{ 0 };
+  uint64_t line{ 0 };
+  std::string record;
+  ActionValues values;
+
+  bool operator<(const Mistake& other) const { return loss > other.loss; }
+};
+
+/// Per-player totals.
+struct PlayerReport {
+  uint64_t decisions{ 0 };
+  uint64_t errors{ 0 };
+  double loss{ 0 };
+};
+
+/// What one worker found.
+struct WorkerReport {
+  std::map<std::string, PlayerReport> players;
+  std::priority_queue<Mistake> worst;  ///< Min-heap of the top mistakes
+  uint64_t invalid{ 0 };
+  uint64_t first_invalid{ 0 };
+  size_t states{ 0 };
+  uint64_t hits{ 0 };
+};
+
+/// Bounded queue between the reader and the workers.
+class BatchQueue {
+public:
+  explicit BatchQueue(size_t capacity) : capacity{ capacity } {}
+
+  void push(Batch b) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [this] { return batches.size() < capacity; });
+    batches.push(std::move(b));
+    not_empty.notify_one();
+  }
+
+  /// False once the queue is closed and empty.
+  bool pop(Batch& b) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this] { return closed or not batches.empty(); });
+    if (batches.empty()) {
+      return false;
+    }
+    b = std::move(batches.front());
+    batches.pop();
+    not_full.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+  }
+
+private:
+  size_t capacity;
+  std::queue<Batch> batches;
+  std::mutex mutex;
+  std::condition_variable not_empty, not_full;
+  bool closed{ false };
+};
+
+/// Parses a non-negative integer (no sign, no trailing characters, no overflow).
+bool parse_count(const std::string& text, size_t& value) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    value = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+void run_worker(const GameRules& rules, BatchQueue& queue, size_t top, WorkerReport& report) {
+  TurnEvaluator evaluator(rules.dice_and_faces);
+  DecisionRecord r;
+  Batch batch;
+  while (queue.pop(batch)) {
+    for (size_t i = 0; i < batch.lines.size(); ++i) {
+      const auto& line = batch.lines[i];
+      auto number = batch.first_line + i;
+      if (line.empty()) {
+        continue;
+      }
+      if (not r.parse(line)
+          or r.turn.drawable() + r.turn.hand.size() + r.turn.shots != rules.total_dice()
+          or r.turn.shots >= TurnModel::shots_to_bust) {
+        if (report.invalid++ == 0 or number < report.first_invalid) {
+          report.first_invalid = number;
+        }
+        continue;
+      }
+
+      auto target = r.best_opponent >= rules.brains_to_win ? r.best_opponent + 1
+                                                            : rules.brains_to_win;
+      auto need = target > r.banked ? target - r.banked : 0;
+      auto v = evaluator.evaluate(r.turn, need);
+      auto chosen = r.hold ? v.hold : v.roll;
+      auto loss = std::max(v.hold, v.roll) - chosen;
+
+      auto& p = report.players[r.player];
+      p.decisions++;
+      if (loss > 1e-9) {
+        p.errors++;
+        p.loss += loss;
+        if (top > 0 and (report.worst.size() < top or loss > report.worst.top().loss)) {
+          report.worst.push({ loss, number, line, v });
+          if (report.worst.size() > top) {
+            report.worst.pop();
+          }
+        }
+      }
+    }
+  }
+  report.states = evaluator.states();
+  report.hits = evaluator.cache_hits();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <config.ini> <decisions|-> [--threads T] [--top K] [--batch N]\n";
+    return EXIT_FAILURE;
+  }
+
+  GameRules rules;
+  rules.load(IniParser(argv[1]));
+  std::string error;
+  if (not rules.playable(error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  std::string path{ argv[2] };
+  size_t threads = std::max(1u, std::thread::hardware_concurrency()), top = 20, lines = 4096;
+
+  for (int i = 3; i < argc; i += 2) {
+    std::string flag{ argv[i] };
+    if (i + 1 == argc) {
+      std::cerr << "Option " << flag << " needs a value.\n";
+      return EXIT_FAILURE;
+    }
+    std::string value{ argv[i + 1] };
+    size_t* number = flag == "--threads" ? &threads
+                     : flag == "--top"   ? &top
+                     : flag == "--batch" ? &lines
+                                         : nullptr;
+    if (number == nullptr) {
+      std::cerr << "Unknown option " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+    if (not parse_count(value, *number)) {
+      std::cerr << "Invalid value \"" << value << "\" for " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+  }
+  threads = std::max<size_t>(1, threads);
+  lines = std::max<size_t>(1, lines);
+
+  std::ifstream file;
+  if (path != "-") {
+    file.open(path);
+    if (not file) {
+      std::cerr << "Could not open \"" << path << "\".\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::istream& in = path == "-" ? std::cin : file;
+
+  auto start = std::chrono::steady_clock::now();
+  BatchQueue queue(2 * threads);
+  std::vector<WorkerReport> reports(threads);
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back(run_worker, std::cref(rules), std::ref(queue), top, std::ref(reports[t]));
+  }
+
+  uint64_t line_number = 0;
+  Batch batch;
+  batch.first_line = 1;
+  for (std::string line; std::getline(in, line);) {
+    batch.lines.push_back(std::move(line));
+    if (batch.lines.size() == lines) {
+      line_number += batch.lines.size();
+      queue.push(std::move(batch));
+      batch = {};
+      batch.first_line = line_number + 1;
+    }
+  }
+  line_number += batch.lines.size();
+  queue.push(std::move(batch));
+  queue.close();
+  for (auto& w : workers) {
+    w.join();
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  WorkerReport total;
+  size_t states = 0;
+  uint64_t hits = 0;
+  std::vector<Mistake> worst;
+  for (auto& r : reports) {
+    for (const auto& [name, p] : r.players) {
+      auto& t = total.players[name];
+      t.decisions += p.decisions;
+      t.errors += p.errors;
+      t.loss += p.loss;
+    }
+    if (r.invalid > 0 and (total.invalid == 0 or r.first_invalid < total.first_invalid)) {
+      total.first_invalid = r.first_invalid;
+    }
+    total.invalid += r.invalid;
+    states += r.states;
+    hits += r.hits;
+    for (; not r.worst.empty(); r.worst.pop()) {
+      worst.push_back(r.worst.top());
+    }
+  }
+  std::sort(worst.begin(), worst.end());
+  worst.resize(std::min(worst.size(), top));
+
+  uint64_t decisions = 0;
+  std::cout << std::fixed << std::setprecision(3) << std::left << std::setw(20) << "player"
+            << std::right << std::setw(12) << "decisions" << std::setw(10) << "errors"
+            << std::setw(10) << "rate" << std::setw(14) << "brains lost" << std::setw(14)
+            << "lost/decision" << "\n";
+  for (const auto& [name, p] : total.players) {
+    decisions += p.decisions;
+    std::cout << std::left << std::setw(20) << name << std::right << std::setw(12) << p.decisions
+              << std::setw(10) << p.errors << std::setw(9) << 100.0 * p.errors / p.decisions
+              << "%" << std::setw(14) << p.loss << std::setw(14) << p.loss / p.decisions << "\n";
+  }
+
+  if (not worst.empty()) {
+    std::cout << "\nCostliest mistakes (line: record | hold, roll value in brains):\n";
+    for (const auto& m : worst) {
+      std::cout << "  " << m.line << ": " << m.record << " | " << m.values.hold << ", "
+                << m.values.roll << " (-" << m.loss << ")\n";
+    }
+  }
+
+  std::cout << "\n" << decisions << " decisions from " << line_number << " lines in "
+            << std::setprecision(2) << seconds << " s (" << std::setprecision(0)
+            << decisions / std::max(seconds, 1e-9) << "/s), " << states << " states solved, "
+            << hits << " cache hits, " << threads << " thread(s).\n";
+  if (total.invalid > 0) {
+    std::cout << total.invalid << " invalid line(s), the first at line " << total.first_invalid
+              << ".\n";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file zdist.cpp
+ *
+ * @description
+ * Exact per-turn score distributions (ScoreDistribution) for turn policies.
+ * Turns that put the brains back in the bag are approximated, since the
+ * canonical states ignore the order of the hand (see TurnState::canonical()).
+ *
+ * For each policy ("t4": hold at 4 brains, "t4s2": hold at 4 brains or 2
+ * shots) the report gives the probability of banking each number of brains
+ * in one turn from a full bag (a bust banks 0), the expected brains and the
+ * chance of reaching brains_to_win in a single turn, with the time taken and
+ * the number of canonical states solved.
+ *
+ * With --queries N, the distributions are also asked from N mid-turn states
+ * sampled from simulated games, as tools built on the engine do; those
+ * queries reuse the memoized states and the rate is reported.
+ *
+ * Build: g++ -std=c++17 -O2 tools/zdist.cpp -o zdist
+ * Usage: ./zdist <config.ini> [t1,t2,t3,t4,t5,t2s2] [--queries N]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/score_distribution.hpp"
+#include "../include/simulator.hpp"
+
+/// Mid-turn states met by threshold players in simulated games.
+std::vector<TurnState> sample_states(const GameRules& rules, size_t n) {
+  std::vector<TurnState> states;
+  Simulator sim(rules);
+  auto policy = make_policy("t3");
+  for (uint64_t game = 0; states.size() < n; ++game) {
+    sim.start(2, game_seed(2024, game));
+    while (not sim.over() and states.size() < n) {
+      auto v = sim.view();
+      states.push_back(v.turn);
+      sim.decide(policy(v));
+    }
+  }
+  return states;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini> [t1,t2,t3,t4,t5,t2s2] [--queries N]\n";
+    return EXIT_FAILURE;
+  }
+
+  GameRules rules;
+  rules.load(IniParser(argv[1]));
+  std::string error;
+  if (not rules.playable(error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  std::string specs = "t1,t2,t3,t4,t5,t2s2";
+  size_t queries = 0;
+  for (int i = 2; i < argc; ++i) {
+    std::string arg{ argv[i] };
+    if (arg == "--queries") {
+      std::string value = i + 1 < argc ? argv[++i] : "";
+      if (value.empty() or value.find_first_not_of("0123456789") != std::string::npos
+          or value.size() > 9) {
+        std::cerr << "Option --queries needs a count.\n";
+        return EXIT_FAILURE;
+      }
+      queries = std::stoul(value);
+    } else if (arg.rfind("--", 0) == 0) {
+      std::cerr << "Unknown option " << arg << ".\n";
+      return EXIT_FAILURE;
+    } else {
+      specs = arg;
+    }
+  }
+
+  using clock = std::chrono::steady_clock;
+  std::vector<std::string> names;
+  std::vector<std::unique_ptr<ScoreDistribution>> engines;
+  std::vector<std::vector<double>> turns;
+  std::vector<double> millis;
+  std::stringstream ss(specs);
+  for (std::string spec; std::getline(ss, spec, ',');) {
+    auto policy = make_turn_policy(spec);
+    if (not policy) {
+      std::cerr << "Invalid policy \"" << spec << "\" (use t3 or t3s2).\n";
+      return EXIT_FAILURE;
+    }
+    auto begin = clock::now();
+    engines.push_back(std::make_unique<ScoreDistribution>(rules.dice_and_faces, policy));
+    turns.push_back(engines.back()->turn());
+    millis.push_back(std::chrono::duration<double, std::milli>(clock::now() - begin).count());
+    names.push_back(spec);
+  }
+
+  // Rows up to the largest score any policy reaches with probability >= 1e-6.
+  size_t rows = 1;
+  for (const auto& p : turns) {
+    for (size_t k = 0; k < p.size(); ++k) {
+      if (p[k] >= 1e-6) {
+        rows = std::max(rows, k + 1);
+      }
+    }
+  }
+
+  std::cout << "Brains banked in one turn (" << rules.canonical() << "):\n\n"
+            << std::fixed << std::setw(10) << "brains";
+  for (const auto& n : names) {
+    std::cout << std::setw(10) << n;
+  }
+  std::cout << "\n";
+  for (size_t k = 0; k < rows; ++k) {
+    std::cout << std::setw(10) << k;
+    for (const auto& p : turns) {
+      std::cout << std::setw(9) << std::setprecision(3) << 100 * p[k] << "%";
+    }
+    std::cout << "\n";
+  }
+
+  std::cout << "\n" << std::setw(10) << "mean";
+  for (const auto& p : turns) {
+    std::cout << std::setw(10) << std::setprecision(3) << ScoreDistribution::mean(p);
+  }
+  std::cout << "\n" << std::setw(10) << "reach " + std::to_string(rules.brains_to_win);
+  for (const auto& p : turns) {
+    double reach = 0;
+    for (size_t k = std::min(rules.brains_to_win, p.size()); k < p.size(); ++k) {
+      reach += p[k];
+    }
+    std::cout << std::setw(9) << std::setprecision(3) << 100 * reach << "%";
+  }
+  std::cout << "\n" << std::setw(10) << "states";
+  for (const auto& e : engines) {
+    std::cout << std::setw(10) << e->states();
+  }
+  std::cout << "\n" << std::setw(10) << "sweeps";
+  for (const auto& e : engines) {
+    std::cout << std::setw(10) << e->cycle_sweeps();
+  }
+  std::cout << "\n" << std::setw(10) << "ms";
+  for (auto ms : millis) {
+    std::cout << std::setw(10) << std::setprecision(2) << ms;
+  }
+  std::cout << "\n";
+
+  if (queries > 0) {
+    auto states = sample_states(rules, queries);
+    auto begin = clock::now();
+    double checksum = 0;
+    for (auto& e : engines) {
+      for (const auto& s : states) {
+        checksum += e->of(s)[0];
+      }
+    }
+    auto seconds = std::chrono::duration<double>(clock::now() - begin).count();
+    auto total = double(states.size() * engines.size());
+    std::cout << "\n" << std::setprecision(0) << total << " mid-turn distributions in "
+              << std::setprecision(3) << seconds << " s (" << std::setprecision(0)
+              << total / std::max(seconds, 1e-9) << "/s, mean P(0) " << std::setprecision(4)
+              << checksum / total << ").\n";
+  }
+  return EXIT_SUCCESS;
+}
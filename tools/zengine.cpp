@@ -0,0 +1,288 @@
+/**
+ * @file zengine.cpp
+ *
+ * @description
+ * Line-protocol engine for external bots, in the spirit of chess engines' UCI.
+ *
+ * The bot talks to the engine over stdin/stdout. Many games are multiplexed on
+ * the same pipe by game id, and the engine reads and answers in batches: it
+ * consumes everything the bot has already written, then answers all of it with
+ * a single write. A bot that sends its decisions for many games at once pays
+ * one round trip per batch instead of one per roll. The engine blocks when the
+ * output pipe is full, so a bot should bound the games in flight (a few hundred
+ * is plenty) or read while it writes.
+ *
+ * Games run on the Simulator (the rules of GameController::update(), checked
+ * by zverify). Seats listed as "ext" are played by the bot; the other seats
+ * take threshold policies (t3, t4s2, ...) and are played by the engine.
+ *
+ * Bot -> engine (one command per line):
+ *   zdi                              handshake; answered with "zdiok"
+ *   isready                          answered with "readyok"
+ *   setoption events on|off          report rolls/busts/ties (default: on)
+ *   new <id> <seat,seat,...> [seed]  start game <id>, e.g. "new g1 ext,t3 42"
+ *                                    (an id still in play, or a seed that is
+ *                                    not a 64-bit number, is refused)
+ *   roll <id> / hold <id>            decision for the pending "state" of <id>
+ *   quit
+ *
+ * Engine -> bot:
+ *   state <id> player <seat> need <brains_to_win> scores <s0,s1,...>
+ *         bag <green,yellow,red> tail <dice> hand <dice> shots <dice> tie <0|1>
+ *   event <id> <roll|hold|bust|tie|end> player=<i> ... seat=<seat>
+ *   result <id> winner <seat> turns <n>
+ *   error <id> <message>
+ *
+ * In events, `player` is the index among the players still in the game and
+ * `seat` the seat of the same player, as numbered in `state` and `result`;
+ * they differ once a tie-break has eliminated a player.
+ *
+ * Dice lists use g (green/weak), y (yellow/tough) and r (red/strong), "-" when
+ * empty. `tail` holds the known dice at the end of the bag (footprints and
+ * returned brains), the last one being the next to be rolled; `bag` counts the
+ * remaining dice of unknown order.
+ *
+ * Build: g++ -std=c++17 -O2 tools/zengine.cpp -o zengine
+ * Usage: ./zengine <config.ini>
+ */
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../include/simulator.hpp"
+
+/// Parses a 64-bit seed (digits only, no overflow).
+bool parse_seed(const std::string& text, uint64_t& seed) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    seed = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+/// A game in progress; seats without a policy are played by the bot.
+struct Table {
+  explicit Table(const GameRules& rules) : sim{ rules } {}
+
+  Simulator sim;
+  std::vector<Policy> seats;
+};
+
+class Engine {
+public:
+  explicit Engine(const GameRules& rules) : rules{ rules } {}
+
+  /// Reads commands until "quit" or end of input.
+  void run() {
+    std::vector<char> buffer(1 << 16);
+    std::string pending;
+    while (true) {
+      auto n = read(STDIN_FILENO, buffer.data(), buffer.size());
+      if (n <= 0) {
+        break;
+      }
+      pending.append(buffer.data(), size_t(n));
+
+      size_t start = 0;
+      for (auto end = pending.find('\n'); end != std::string::npos;
+           end = pending.find('\n', start)) {
+        if (not command(pending.substr(start, end - start))) {
+          flush();
+          return;
+        }
+        start = end + 1;
+      }
+      pending.erase(0, start);
+      flush();
+    }
+    flush();
+  }
+
+private:
+  const GameRules& rules;
+  std::unordered_map<std::string, std::unique_ptr<Table>> games;
+  std::string out;
+  bool events{ true };
+
+  void flush() {
+    for (size_t done = 0; done < out.size();) {
+      auto n = write(STDOUT_FILENO, out.data() + done, out.size() - done);
+      if (n <= 0) {
+        break;
+      }
+      done += size_t(n);
+    }
+    out.clear();
+  }
+
+  void error(const std::string& id, const std::string& message) {
+    out += "error " + id + " " + message + "\n";
+  }
+
+  static std::string dice(const uint8_t* first, const uint8_t* last) {
+    static const char letters[]{ 'g', 'y', 'r' };
+    std::string s;
+    for (auto it = first; it != last; ++it) {
+      s += letters[*it % 3];
+    }
+    return s.empty() ? "-" : s;
+  }
+
+  /// Processes one line; false on "quit".
+  bool command(const std::string& line) {
+    std::istringstream in(line);
+    std::string verb, id;
+    in >> verb >> id;
+
+    if (verb.empty()) {
+      return true;
+    }
+    if (verb == "quit") {
+      return false;
+    }
+    if (verb == "zdi") {
+      out += "id name zengine\nid rules " + rules.canonical() + "\noption events on|off\nzdiok\n";
+    } else if (verb == "isready") {
+      out += "readyok\n";
+    } else if (verb == "setoption") {
+      std::string value;
+      in >> value;
+      if (id != "events" or (value != "on" and value != "off")) {
+        error("-", "unknown option");
+      } else {
+        events = value == "on";
+      }
+    } else if (verb == "new") {
+      start(id, in);
+    } else if (verb == "roll" or verb == "hold") {
+      auto it = games.find(id);
+      if (it == games.end()) {
+        error(id.empty() ? "-" : id, "no such game");
+      } else {
+        it->second->sim.decide(verb == "hold");
+        advance(id, *it->second);
+      }
+    } else {
+      error("-", "unknown command \"" + verb + "\"");
+    }
+    return true;
+  }
+
+  void start(const std::string& id, std::istringstream& in) {
+    std::string lineup;
+    uint64_t seed = 0;
+    in >> lineup;
+    if (id.empty() or lineup.empty()) {
+      error("-", "usage: new <id> <seat,seat,...> [seed]");
+      return;
+    }
+    if (games.count(id) != 0) {
+      error(id, "game exists");
+      return;
+    }
+    // Without a seed the game is random; a malformed one is refused, not replaced.
+    std::string seed_text;
+    if (not(in >> seed_text)) {
+      seed = std::random_device{}();
+    } else if (not parse_seed(seed_text, seed)) {
+      error(id, "invalid seed \"" + seed_text + "\"");
+      return;
+    }
+
+    auto table = std::make_unique<Table>(rules);
+    std::stringstream ss(lineup);
+    for (std::string seat; std::getline(ss, seat, ',');) {
+      auto policy = seat == "ext" ? Policy{} : make_policy(seat);
+      if (seat != "ext" and not policy) {
+        error(id, "invalid seat \"" + seat + "\"");
+        return;
+      }
+      table->seats.push_back(policy);
+    }
+    if (table->seats.size() < 2 or table->seats.size() > GameResult::max_seats) {
+      error(id, "a game needs 2 to " + std::to_string(GameResult::max_seats) + " seats");
+      return;
+    }
+
+    if (events) {
+      const auto& sim = table->sim;
+      table->sim.observe([this, id, &sim](const GameEvent& e) {
+        if (e.kind != FIRST_PLAYER) {
+          out += "event " + id + " " + e.str() + " seat=" + std::to_string(sim.seat_of(e.player))
+                 + "\n";
+        }
+      });
+    }
+    table->sim.start(table->seats.size(), seed);
+    auto& ref = *table;
+    games[id] = std::move(table);
+    advance(id, ref);
+  }
+
+  /// Plays the engine's seats until the bot must decide or the game ends.
+  void advance(const std::string& id, Table& table) {
+    auto& sim = table.sim;
+    while (not sim.over()) {
+      const auto& policy = table.seats[sim.seat()];
+      if (not policy) {
+        state(id, table);
+        return;
+      }
+      sim.decide(policy(sim.view()));
+    }
+
+    auto r = sim.result();
+    out += "result " + id + " winner " + std::to_string(r.winner) + " turns "
+           + std::to_string(r.turns) + "\n";
+    games.erase(id);
+  }
+
+  void state(const std::string& id, const Table& table) {
+    auto v = table.sim.view();
+    auto r = table.sim.result();
+    std::vector<uint8_t> shots;
+    for (const auto& d : table.sim.shots()) {
+      shots.push_back(d.type);
+    }
+
+    out += "state " + id + " player " + std::to_string(v.seat) + " need "
+           + std::to_string(v.brains_to_win) + " scores ";
+    for (size_t seat = 0; seat < table.seats.size(); ++seat) {
+      out += (seat == 0 ? "" : ",") + std::to_string(r.brains[seat]);
+    }
+    out += " bag " + std::to_string(v.turn.pool[WEAK]) + "," + std::to_string(v.turn.pool[TOUGH])
+           + "," + std::to_string(v.turn.pool[STRONG]);
+    out += " tail " + dice(v.turn.tail.begin(), v.turn.tail.end());
+    out += " hand " + dice(v.turn.hand.begin(), v.turn.hand.end());
+    out += " shots " + dice(shots.data(), shots.data() + shots.size());
+    out += std::string(" tie ") + (v.tie ? "1" : "0") + "\n";
+  }
+};
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini>\n";
+    return EXIT_FAILURE;
+  }
+  GameRules rules;
+  rules.load(IniParser(argv[1]));
+  std::string error;
+  if (not rules.playable(error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  Engine(rules).run();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file zsim.cpp
+ *
+ * @description
+ * Sharded, checkpointed and resumable simulation campaigns.
+ *
+ * A campaign of N games is split into deterministic shards; game i always uses
+ * the seed game_seed(seed, i), whatever shard or process runs it. Worker
+ * processes claim shards with an advisory lock, checkpoint their partial
+ * statistics every few seconds and can be killed at any time: running the
+ * same command again resumes only the unfinished shards. Several machines can
+ * share the job directory. When every shard is done the partial results are
+ * merged, in any order, into `report.txt`.
+ *
+ * Build: g++ -std=c++17 -O2 tools/zsim.cpp -o zsim
+ * Usage: ./zsim <config.ini> <job_dir> [--games N] [--shards S] [--workers W]
+ *               [--seed X] [--lineup t2,t3s2,...]
+ *
+ * The job parameters are stored in <job_dir>/job.ini when the job is created;
+ * reruns read them back and refuse to mix results from different rules or
+ * from a different --games, --shards, --seed or --lineup.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/simulator.hpp"
+
+/// Parameters of a campaign, stored in job.ini.
+struct Job {
+  GameRules rules;
+  uint64_t games{ 1000000 };
+  uint64_t shards{ 64 };
+  uint64_t seed{ 2024 };
+  std::string lineup{ "t2,t3" };
+
+  uint64_t hash() const {
+    uint64_t h = rules.hash();
+    for (unsigned char c : std::to_string(games) + "/" + std::to_string(shards) + "/"
+                             + std::to_string(seed) + "/" + lineup) {
+      h = (h ^ c) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+  uint64_t first_game(uint64_t shard) const { return shard * games / shards; }
+  uint64_t shard_games(uint64_t shard) const { return first_game(shard + 1) - first_game(shard); }
+};
+
+/// On-disk checkpoint of one shard (fixed-size, written atomically).
+struct ShardCheckpoint {
+  static constexpr uint32_t magic_value = 0x5a44534b;  // "ZDSK"
+  static constexpr uint32_t version_value = 1;
+
+  uint32_t magic{ magic_value };
+  uint32_t version{ version_value };
+  uint64_t job_hash{ 0 };
+  uint64_t shard{ 0 };
+  uint64_t games_done{ 0 };
+  uint64_t games_total{ 0 };
+  SimStats stats;
+
+  bool done() const { return games_done == games_total; }
+};
+
+std::string shard_path(const std::string& dir, uint64_t shard, const char* ext) {
+  std::ostringstream oss;
+  oss << dir << "/shard-" << std::setw(5) << std::setfill('0') << shard << ext;
+  return oss.str();
+}
+
+bool load_checkpoint(const std::string& path, const Job& job, ShardCheckpoint& ckpt) {
+  std::ifstream in{ path, std::ios::binary };
+  ShardCheckpoint c;
+  if (not in.read(reinterpret_cast<char*>(&c), sizeof(c))) {
+    return false;
+  }
+  if (c.magic != ShardCheckpoint::magic_value or c.version != ShardCheckpoint::version_value
+      or c.job_hash != job.hash()) {
+    return false;
+  }
+  ckpt = c;
+  return true;
+}
+
+/// Writes to a temporary file, syncs and renames over the previous checkpoint.
+void save_checkpoint(const std::string& path, const ShardCheckpoint& ckpt) {
+  auto tmp = path + ".tmp." + std::to_string(getpid());
+  int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return;
+  }
+  auto ok = write(fd, &ckpt, sizeof(ckpt)) == sizeof(ckpt) and fsync(fd) == 0;
+  close(fd);
+  if (ok) {
+    rename(tmp.c_str(), path.c_str());
+  } else {
+    unlink(tmp.c_str());
+  }
+}
+
+/// Parses a non-negative integer (no sign, no trailing characters, no overflow).
+bool parse_count(const std::string& text, uint64_t& value) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    value = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+std::vector<Policy> make_lineup(const std::string& spec) {
+  std::vector<Policy> lineup;
+  std::stringstream ss(spec);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    auto policy = make_policy(token);
+    if (not policy) {
+      return {};
+    }
+    lineup.push_back(policy);
+  }
+  return lineup;
+}
+
+/// Runs (or resumes) one shard if no other process holds it.
+void run_shard(const std::string& dir, const Job& job, uint64_t shard) {
+  auto lock_path = shard_path(dir, shard, ".lock");
+  int lock = open(lock_path.c_str(), O_CREAT | O_RDWR, 0644);
+  if (lock < 0 or flock(lock, LOCK_EX | LOCK_NB) != 0) {
+    if (lock >= 0) {
+      close(lock);
+    }
+    return;
+  }
+
+  auto path = shard_path(dir, shard, ".ckpt");
+  ShardCheckpoint ckpt;
+  if (not load_checkpoint(path, job, ckpt)) {
+    ckpt = ShardCheckpoint{};
+    ckpt.job_hash = job.hash();
+    ckpt.shard = shard;
+    ckpt.games_total = job.shard_games(shard);
+  }
+
+  Simulator sim(job.rules);
+  auto lineup = make_lineup(job.lineup);
+  auto first = job.first_game(shard);
+  auto last_save = std::chrono::steady_clock::now();
+
+  while (not ckpt.done()) {
+    ckpt.stats.add(sim.play(lineup, game_seed(job.seed, first + ckpt.games_done)));
+    ckpt.games_done++;
+    if (ckpt.games_done % 4096 == 0
+        and std::chrono::steady_clock::now() - last_save > std::chrono::seconds(5)) {
+      save_checkpoint(path, ckpt);
+      last_save = std::chrono::steady_clock::now();
+    }
+  }
+  save_checkpoint(path, ckpt);
+  close(lock);
+}
+
+void worker(const std::string& dir, const Job& job, uint64_t id, uint64_t workers) {
+  // Each worker starts at a different shard so they rarely contend for the same lock.
+  auto start = id * job.shards / workers;
+  for (uint64_t k = 0; k < job.shards; ++k) {
+    run_shard(dir, job, (start + k) % job.shards);
+  }
+}
+
+void write_job(const std::string& path, const Job& job) {
+  std::ofstream out{ path };
+  out << "# zsim job, do not edit\n"
+      << "rules = \"" << job.rules.canonical() << "\"\n"
+      << "games = " << job.games << "\n"
+      << "shards = " << job.shards << "\n"
+      << "seed = " << job.seed << "\n"
+      << "lineup = " << job.lineup << "\n";
+}
+
+void report(std::ostream& out, const Job& job, const SimStats& s) {
+  auto finished = s.games - s.unfinished;
+  auto pct = [](double a, double b) { return b == 0 ? 0.0 : 100.0 * a / b; };
+  out << std::fixed << std::setprecision(2);
+  out << "rules: " << job.rules.canonical() << "\n"
+      << "games: " << s.games << " (unfinished: " << s.unfinished << ")\n"
+      << "tie breaks: " << pct(s.tie_breaks, s.games) << "%\n"
+      << "first player wins: " << pct(s.first_wins, finished) << "%\n"
+      << "average rounds: " << (finished == 0 ? 0.0 : double(s.rounds) / finished) << "\n"
+      << "average turns: " << (s.games == 0 ? 0.0 : double(s.turns) / s.games) << "\n";
+
+  auto lineup = job.lineup + ",";
+  for (size_t seat = 0, pos = 0; pos < lineup.size(); ++seat) {
+    auto next = lineup.find(',', pos);
+    out << "seat " << seat << " (" << lineup.substr(pos, next - pos)
+        << "): wins " << pct(s.wins[seat], finished) << "%, busts "
+        << pct(s.busts[seat], s.seat_turns[seat]) << "% of turns, brains/turn "
+        << (s.seat_turns[seat] == 0 ? 0.0 : double(s.brains[seat]) / s.seat_turns[seat])
+        << "\n";
+    pos = next + 1;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini> <job_dir> [--games N] [--shards S]"
+              << " [--workers W] [--seed X] [--lineup t2,t3s2,...]\n";
+    return EXIT_FAILURE;
+  }
+
+  Job job;
+  job.rules.load(IniParser(argv[1]));
+  std::string error;
+  if (not job.rules.playable(error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  std::string dir{ argv[2] };
+  uint64_t workers = std::max(1u, std::thread::hardware_concurrency());
+
+  // Keys of the job parameters given on the command line (as in job.ini).
+  std::vector<std::string> given;
+  for (int i = 3; i < argc; i += 2) {
+    std::string flag{ argv[i] };
+    if (i + 1 == argc) {
+      std::cerr << "Option " << flag << " needs a value.\n";
+      return EXIT_FAILURE;
+    }
+    std::string value{ argv[i + 1] };
+    uint64_t* number = flag == "--games"     ? &job.games
+                       : flag == "--shards"  ? &job.shards
+                       : flag == "--workers" ? &workers
+                       : flag == "--seed"    ? &job.seed
+                                             : nullptr;
+    if (number != nullptr) {
+      if (not parse_count(value, *number)) {
+        std::cerr << "Invalid value \"" << value << "\" for " << flag << ".\n";
+        return EXIT_FAILURE;
+      }
+      if (flag != "--workers") {
+        given.push_back(flag.substr(2));
+      }
+    } else if (flag == "--lineup") {
+      job.lineup = value;
+      given.push_back("lineup");
+    } else {
+      std::cerr << "Unknown option " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+  }
+  workers = std::max<uint64_t>(1, workers);
+
+  // Checked before job.ini is written, so a bad command never creates a job it cannot run.
+  auto valid_lineup = [&job] {
+    auto size = make_lineup(job.lineup).size();
+    if (size < 2 or size > GameResult::max_seats) {
+      std::cerr << "Invalid lineup \"" << job.lineup << "\" (2 to " << GameResult::max_seats
+                << " policies like t3 or t3s2).\n";
+      return false;
+    }
+    return true;
+  };
+  if (not valid_lineup()) {
+    return EXIT_FAILURE;
+  }
+  job.shards = std::max<uint64_t>(1, std::min(job.shards, job.games));
+  auto value_of = [&job](const std::string& key) {
+    return key == "games"    ? std::to_string(job.games)
+           : key == "shards" ? std::to_string(job.shards)
+           : key == "seed"   ? std::to_string(job.seed)
+                             : job.lineup;
+  };
+
+  mkdir(dir.c_str(), 0755);
+  auto job_path = dir + "/job.ini";
+  if (access(job_path.c_str(), F_OK) == 0) {
+    IniParser saved(job_path);
+    if (saved.get("rules") != job.rules.canonical()) {
+      std::cerr << "Job \"" << dir << "\" was created with different rules:\n  "
+                << saved.get("rules") << "\n";
+      return EXIT_FAILURE;
+    }
+    for (const auto& key : given) {
+      if (saved.get(key) != value_of(key)) {
+        std::cerr << "Job \"" << dir << "\" was created with " << key << " = "
+                  << saved.get(key) << "; drop --" << key << " or use another job directory.\n";
+        return EXIT_FAILURE;
+      }
+    }
+    if (not parse_count(saved.get("games"), job.games)
+        or not parse_count(saved.get("shards"), job.shards)
+        or not parse_count(saved.get("seed"), job.seed)) {
+      std::cerr << "Job file \"" << job_path << "\" is damaged.\n";
+      return EXIT_FAILURE;
+    }
+    job.lineup = saved.get("lineup");
+    if (not valid_lineup()) {
+      std::cerr << "Job file \"" << job_path << "\" is damaged.\n";
+      return EXIT_FAILURE;
+    }
+    job.shards = std::max<uint64_t>(1, std::min(job.shards, job.games));
+  } else {
+    write_job(job_path, job);
+  }
+
+  std::vector<pid_t> children;
+  for (uint64_t w = 0; w < workers; ++w) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      worker(dir, job, w, workers);
+      _exit(EXIT_SUCCESS);
+    }
+    if (pid > 0) {
+      children.push_back(pid);
+    }
+  }
+  for (auto pid : children) {
+    waitpid(pid, nullptr, 0);
+  }
+
+  SimStats total;
+  uint64_t done = 0;
+  for (uint64_t shard = 0; shard < job.shards; ++shard) {
+    ShardCheckpoint ckpt;
+    if (load_checkpoint(shard_path(dir, shard, ".ckpt"), job, ckpt)) {
+      total.merge(ckpt.stats);
+      done += ckpt.done();
+    }
+  }
+
+  report(std::cout, job, total);
+  if (done < job.shards) {
+    std::cout << done << "/" << job.shards << " shards done; run again to resume.\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream out{ dir + "/report.txt" };
+  report(out, job, total);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file zspectate.cpp
+ *
+ * @description
+ * Spectator for a Zombie Dice table that is broadcasting its frames
+ * (see `broadcast_channel` in zdice.ini). Any number of spectators can attach
+ * to the same channel; a spectator that falls behind skips to the latest
+ * keyframe instead of slowing the table down.
+ *
+ * Build: g++ -std=c++17 -O2 tools/zspectate.cpp -o zspectate
+ * Usage: ./zspectate <channel>
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../include/frame_broadcast.hpp"
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <channel>\n";
+    return EXIT_FAILURE;
+  }
+
+  FrameReader reader(argv[1]);
+  if (not reader.is_open()) {
+    std::cerr << "Channel \"" << argv[1] << "\" is not being broadcast.\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string out;
+  FrameKind kind;
+  std::string_view content;
+
+  while (not reader.finished()) {
+    out.clear();
+    while (reader.next_frame(kind, content)) {
+      if (kind == EVENT) {
+        continue;
+      }
+      auto mark = out.size();
+      out.append(content);
+      if (not reader.still_valid()) {
+        out.resize(mark);
+      }
+    }
+    if (out.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      continue;
+    }
+    std::cout << out << std::flush;
+  }
+  std::cout << '\n';
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file zstats.cpp
+ *
+ * @description
+ * Queries the lifetime player statistics recorded by the game
+ * (see `stats_file` in zdice.ini).
+ *
+ * Build: g++ -std=c++17 -O2 tools/zstats.cpp -o zstats
+ * Usage: ./zstats <file> top <n> [metric]
+ *        ./zstats <file> show <name> [metric]
+ *
+ * Metrics: games, wins, win_rate, tie_breaks, busts, brains_per_turn, longest_streak.
+ */
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "../include/stats_store.hpp"
+
+const std::map<std::string, StatsStore::Metric> metrics{
+  { "games", [](const PlayerRecord& r) { return double(r.games); } },
+  { "wins", [](const PlayerRecord& r) { return double(r.wins); } },
+  { "win_rate", [](const PlayerRecord& r) { return r.games == 0 ? 0.0 : double(r.wins) / r.games; } },
+  { "tie_breaks", [](const PlayerRecord& r) { return double(r.tie_breaks); } },
+  { "busts", [](const PlayerRecord& r) { return double(r.busts); } },
+  { "brains_per_turn", [](const PlayerRecord& r) { return r.brains_per_turn(); } },
+  { "longest_streak", [](const PlayerRecord& r) { return double(r.longest_streak); } },
+};
+
+void print(const PlayerRecord& r) {
+  std::cout << std::left << std::setw(32) << r.name << std::right << " games: " << std::setw(6)
+            << r.games << " wins: " << std::setw(6) << r.wins << " ties: " << std::setw(5)
+            << r.tie_breaks << " busts: " << std::setw(6) << r.busts
+            << " brains/turn: " << std::fixed << std::setprecision(2) << r.brains_per_turn()
+            << " streak: " << r.longest_streak << "\n";
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " <file> top <n> [metric]\n"
+              << "       " << argv[0] << " <file> show <name> [metric]\n";
+    return EXIT_FAILURE;
+  }
+
+  auto metric = metrics.find(argc > 4 ? argv[4] : "wins");
+  if (metric == metrics.end()) {
+    std::cerr << "Unknown metric \"" << argv[4] << "\".\n";
+    return EXIT_FAILURE;
+  }
+
+  StatsStore store;
+  if (not store.open(argv[1])) {
+    std::cerr << "Could not open stats file \"" << argv[1] << "\".\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string command{ argv[2] };
+  if (command == "top") {
+    for (const auto& r : store.top(std::strtoul(argv[3], nullptr, 10), metric->second)) {
+      print(r);
+    }
+  } else if (command == "show") {
+    auto record = store.find(argv[3]);
+    if (not record) {
+      std::cerr << "Player \"" << argv[3] << "\" has no recorded games.\n";
+      return EXIT_FAILURE;
+    }
+    print(*record);
+    std::cout << "Percentile (" << metric->first << "): " << std::fixed << std::setprecision(1)
+              << store.percentile_rank(argv[3], metric->second) << "\n";
+  } else {
+    std::cerr << "Unknown command \"" << command << "\".\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
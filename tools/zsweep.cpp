@@ -0,0 +1,471 @@
+/**
+ * @file zsweep.cpp
+ *
+ * @description
+ * Rule-balance sweeps over grids of zdice.ini rule parameters.
+ *
+ * Each --set expands one rule key into a list of values, either a numeric
+ * range (brains_to_win=8:16:2) or a comma-separated list
+ * (weak_die_faces=bbbffs,bbbbfs). The grid is the cartesian product of all
+ * lists applied over the rules of the base config; a range gives at most 1000
+ * values and the grid at most 100000 variants. Every variant plays the same
+ * seeded games with a fixed bot lineup, with the variants spread over
+ * threads, and the report shows game length, first-player advantage, bust
+ * and tie-break rates per variant.
+ *
+ * Variants the simulator cannot play (fewer than 3 or more than 29 dice, see
+ * GameRules::playable()) are skipped and reported with the reason.
+ *
+ * Results are cached in an append-only file, keyed by the hash of the
+ * effective rules (GameRules::hash()) and of the evaluation (games, seed and
+ * the parsed lineup, so "t3, t3" and "t3,t3" share results). Rerunning a
+ * sweep with overlapping ranges only plays the new points; several sweeps may
+ * share a cache, appends are locked. Records carry a format version and the
+ * size of SimStats; a cache written by an incompatible build is refused.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread tools/zsweep.cpp -o zsweep
+ * Usage: ./zsweep <config.ini> --set key=values [--set key=values ...]
+ *                 [--games N] [--lineup t3,t3] [--threads T] [--seed S]
+ *                 [--cache zsweep.cache]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "../include/simulator.hpp"
+
+/// Most values one --set may expand to, and most variants in the grid.
+constexpr size_t max_axis_values = 1000;
+constexpr size_t max_variants = 100000;
+
+/// A rule key and the values it takes in the grid.
+struct Axis {
+  std::string key;
+  std::vector<std::string> values;
+};
+
+/// How every variant is evaluated (part of the cache key).
+struct Evaluation {
+  uint64_t games{ 10000 };
+  uint64_t seed{ 2024 };
+  std::string lineup{ "t3,t3" };  ///< Canonical form (see parse_lineup())
+
+  uint64_t hash() const {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : std::to_string(games) + "/" + std::to_string(seed) + "/" + lineup) {
+      h = (h ^ c) * 1099511628211ULL;
+    }
+    return h;
+  }
+};
+
+/// One point of the grid.
+struct Variant {
+  std::vector<std::string> values;  ///< Value of each axis
+  GameRules rules;
+  SimStats stats;
+  bool cached{ false };
+  std::string unplayable;  ///< Why the simulator cannot play these rules (empty if it can)
+};
+
+/**
+ * Parses a comma-separated lineup of threshold policies.
+ *
+ * `canonical` receives the lineup rewritten from the parsed thresholds
+ * ("t3s3, t03" becomes "t3,t3"), which is what the cache key uses.
+ */
+bool parse_lineup(const std::string& text, std::vector<Policy>& lineup, std::string& canonical,
+                  std::string& error) {
+  std::stringstream ss(text);
+  canonical.clear();
+  for (std::string token; std::getline(ss, token, ',');) {
+    auto first = token.find_first_not_of(" \t");
+    auto last = token.find_last_not_of(" \t");
+    token = first == std::string::npos ? "" : token.substr(first, last - first + 1);
+    size_t brains = 0, shots = 0;
+    if (not parse_threshold(token, brains, shots)) {
+      error = "invalid policy \"" + token + "\" (use t3 or t3s2)";
+      return false;
+    }
+    lineup.push_back(threshold_policy(brains, shots));
+    canonical += (canonical.empty() ? "t" : ",t") + std::to_string(brains);
+    if (shots != TurnModel::shots_to_bust) {
+      canonical += "s" + std::to_string(shots);
+    }
+  }
+  return true;
+}
+
+/// Parses a non-negative integer (no sign, no trailing characters, no overflow).
+bool parse_count(const std::string& text, uint64_t& value) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    value = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+/// Parses "key=a:b[:step]" or "key=v1,v2,...".
+bool parse_axis(const std::string& spec, Axis& axis, std::string& error) {
+  auto eq = spec.find('=');
+  if (eq == std::string::npos or eq == 0 or eq + 1 == spec.size()) {
+    error = "expected key=values in \"" + spec + "\"";
+    return false;
+  }
+  axis.key = spec.substr(0, eq);
+  auto values = spec.substr(eq + 1);
+
+  if (values.find(':') != std::string::npos) {
+    std::stringstream ss(values);
+    std::vector<uint64_t> bounds;
+    for (std::string n; std::getline(ss, n, ':');) {
+      if (not parse_count(n, bounds.emplace_back())) {
+        error = "invalid range \"" + values + "\"";
+        return false;
+      }
+    }
+    if (bounds.size() < 2 or bounds.size() > 3 or bounds[1] < bounds[0]
+        or (bounds.size() == 3 and bounds[2] == 0)) {
+      error = "invalid range \"" + values + "\" (use first:last[:step])";
+      return false;
+    }
+    auto step = bounds.size() == 3 ? bounds[2] : 1;
+    if ((bounds[1] - bounds[0]) / step >= max_axis_values) {
+      error = "range \"" + values + "\" has more than " + std::to_string(max_axis_values)
+              + " values";
+      return false;
+    }
+    for (uint64_t k = 0; k <= (bounds[1] - bounds[0]) / step; ++k) {
+      axis.values.push_back(std::to_string(bounds[0] + k * step));
+    }
+  } else {
+    std::stringstream ss(values);
+    for (std::string v; std::getline(ss, v, ',');) {
+      axis.values.push_back(v);
+    }
+  }
+
+  GameRules probe;
+  if (not probe.set(axis.key, "1") and not probe.set(axis.key, "b")) {
+    error = "\"" + axis.key + "\" is not a rule key";
+    return false;
+  }
+  for (const auto& v : axis.values) {
+    if (not probe.set(axis.key, v)) {
+      error = "\"" + v + "\" is not a valid value of rule key \"" + axis.key + "\"";
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Cartesian product of the axes over the base rules.
+std::vector<Variant> expand(const GameRules& base, const std::vector<Axis>& axes) {
+  std::vector<Variant> grid(1);
+  grid[0].rules = base;
+  for (const auto& axis : axes) {
+    std::vector<Variant> next;
+    for (const auto& v : grid) {
+      for (const auto& value : axis.values) {
+        auto n = v;
+        n.values.push_back(value);
+        n.rules.set(axis.key, value);
+        next.push_back(n);
+      }
+    }
+    grid = std::move(next);
+  }
+  return grid;
+}
+
+/**
+ * Append-only result cache.
+ *
+ * Each record is a CacheRecord, the canonical rules (`size` bytes) and the
+ * SimStats of the variant (`stats_size` bytes). Records are appended under an
+ * exclusive flock.
+ */
+class ResultCache {
+public:
+  struct CacheRecord {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t stats_size;
+    uint64_t rules_hash;
+    uint64_t evaluation;
+  };
+
+  explicit ResultCache(const std::string& path) : path{ path } {}
+
+  /**
+   * Reads every complete record; a torn last record is ignored.
+   * Returns false if the file was written in another format (version or
+   * SimStats layout), since appending to it would mix record layouts.
+   */
+  bool load() {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return true;
+    }
+    flock(fd, LOCK_SH);
+    std::string data;
+    char buffer[1 << 16];
+    for (ssize_t n; (n = read(fd, buffer, sizeof(buffer))) > 0;) {
+      data.append(buffer, size_t(n));
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    for (size_t pos = 0; pos + sizeof(CacheRecord) <= data.size();) {
+      CacheRecord r;
+      std::memcpy(&r, data.data() + pos, sizeof(r));
+      if (r.magic != magic_value or r.version != version or r.stats_size != sizeof(SimStats)) {
+        return pos > 0;
+      }
+      auto end = pos + sizeof(r) + r.size + sizeof(SimStats);
+      if (end > data.size()) {
+        break;
+      }
+      SimStats stats;
+      std::memcpy(&stats, data.data() + pos + sizeof(r) + r.size, sizeof(stats));
+      entries[key(r.rules_hash, r.evaluation)] = { data.substr(pos + sizeof(r), r.size), stats };
+      pos = end;
+    }
+    return true;
+  }
+
+  bool find(const GameRules& rules, uint64_t evaluation, SimStats& stats) const {
+    auto it = entries.find(key(rules.hash(), evaluation));
+    if (it == entries.end() or it->second.first != rules.canonical()) {
+      return false;
+    }
+    stats = it->second.second;
+    return true;
+  }
+
+  bool store(const GameRules& rules, uint64_t evaluation, const SimStats& stats) {
+    auto canonical = rules.canonical();
+    CacheRecord r{ magic_value, version, uint32_t(canonical.size()), uint32_t(sizeof(SimStats)),
+                   rules.hash(), evaluation };
+    std::string record(reinterpret_cast<const char*>(&r), sizeof(r));
+    record += canonical;
+    record.append(reinterpret_cast<const char*>(&stats), sizeof(stats));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    flock(fd, LOCK_EX);
+    auto ok = write(fd, record.data(), record.size()) == ssize_t(record.size());
+    flock(fd, LOCK_UN);
+    close(fd);
+    return ok;
+  }
+
+private:
+  static constexpr uint32_t magic_value = 0x4357535a;  // "ZSWC"
+  static constexpr uint32_t version = 2;               ///< Layout of CacheRecord
+
+  std::string path;
+  std::unordered_map<std::string, std::pair<std::string, SimStats>> entries;
+  std::mutex mutex;
+
+  static std::string key(uint64_t rules_hash, uint64_t evaluation) {
+    return std::to_string(rules_hash) + "/" + std::to_string(evaluation);
+  }
+};
+
+SimStats evaluate(const GameRules& rules, const Evaluation& eval,
+                  const std::vector<Policy>& lineup) {
+  Simulator sim(rules);
+  SimStats stats;
+  for (uint64_t g = 0; g < eval.games; ++g) {
+    stats.add(sim.play(lineup, game_seed(eval.seed, g)));
+  }
+  return stats;
+}
+
+void report(const std::vector<Axis>& axes, const std::vector<Variant>& grid, size_t seats) {
+  std::cout << std::fixed;
+  for (const auto& axis : axes) {
+    std::cout << std::setw(std::max<int>(8, axis.key.size() + 2)) << axis.key;
+  }
+  std::cout << std::setw(9) << "games" << std::setw(9) << "turns" << std::setw(9) << "rounds"
+            << std::setw(12) << "first win" << std::setw(9) << "edge" << std::setw(9)
+            << "busts" << std::setw(9) << "ties" << std::setw(11) << "unfinished" << "\n";
+
+  for (const auto& v : grid) {
+    for (size_t i = 0; i < axes.size(); ++i) {
+      std::cout << std::setw(std::max<int>(8, axes[i].key.size() + 2)) << v.values[i];
+    }
+    const auto& s = v.stats;
+    if (not v.unplayable.empty()) {
+      std::cout << "  (" << v.unplayable << ")\n";
+      continue;
+    }
+    auto finished = s.games - s.unfinished;
+    uint64_t busts = 0, turns = 0;
+    for (size_t i = 0; i < SimStats::max_seats; ++i) {
+      busts += s.busts[i];
+      turns += s.seat_turns[i];
+    }
+    auto first = finished == 0 ? 0.0 : double(s.first_wins) / finished;
+    std::cout << std::setw(9) << s.games << std::setprecision(2) << std::setw(9)
+              << double(s.turns) / s.games << std::setw(9)
+              << (finished == 0 ? 0.0 : double(s.rounds) / finished) << std::setw(11)
+              << 100 * first << "%" << std::setw(8) << std::showpos
+              << 100 * (first - 1.0 / seats) << "%" << std::noshowpos << std::setw(8)
+              << (turns == 0 ? 0.0 : 100.0 * busts / turns) << "%" << std::setw(8)
+              << 100.0 * s.tie_breaks / s.games << "%" << std::setw(11) << s.unfinished
+              << (v.cached ? "  (cached)" : "") << "\n";
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini> --set key=values [--set key=values ...]"
+              << " [--games N] [--lineup t3,t3] [--threads T] [--seed S]"
+              << " [--cache zsweep.cache]\n";
+    return EXIT_FAILURE;
+  }
+
+  GameRules base;
+  base.load(IniParser(argv[1]));
+  Evaluation eval;
+  std::vector<Axis> axes;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string cache_path = "zsweep.cache";
+
+  std::string lineup_text = eval.lineup;
+  for (int i = 2; i < argc; i += 2) {
+    std::string flag{ argv[i] };
+    if (i + 1 == argc) {
+      std::cerr << "Option " << flag << " needs a value.\n";
+      return EXIT_FAILURE;
+    }
+    std::string value{ argv[i + 1] };
+    uint64_t number = 0;
+    if ((flag == "--games" or flag == "--threads" or flag == "--seed")
+        and not parse_count(value, number)) {
+      std::cerr << "Invalid value \"" << value << "\" for " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+    if (flag == "--set") {
+      Axis axis;
+      std::string error;
+      if (not parse_axis(value, axis, error)) {
+        std::cerr << "Invalid --set: " << error << ".\n";
+        return EXIT_FAILURE;
+      }
+      axes.push_back(axis);
+    } else if (flag == "--games") {
+      eval.games = number;
+    } else if (flag == "--lineup") {
+      lineup_text = value;
+    } else if (flag == "--threads") {
+      threads = std::max<size_t>(1, number);
+    } else if (flag == "--seed") {
+      eval.seed = number;
+    } else if (flag == "--cache") {
+      cache_path = value;
+    } else {
+      std::cerr << "Unknown option " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Policy> lineup;
+  std::string error;
+  if (not parse_lineup(lineup_text, lineup, eval.lineup, error)) {
+    std::cerr << "Invalid --lineup: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  if (lineup.size() < 2 or lineup.size() > GameResult::max_seats) {
+    std::cerr << "The lineup needs 2 to " << GameResult::max_seats << " seats.\n";
+    return EXIT_FAILURE;
+  }
+
+  if (eval.games == 0) {
+    std::cerr << "Option --games needs at least 1 game.\n";
+    return EXIT_FAILURE;
+  }
+  size_t variants = 1;
+  for (const auto& axis : axes) {
+    variants *= axis.values.size();
+    if (variants > max_variants) {
+      std::cerr << "The grid has more than " << max_variants << " variants.\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto grid = expand(base, axes);
+  ResultCache cache(cache_path);
+  if (not cache.load()) {
+    std::cerr << "Cache \"" << cache_path << "\" was written by an incompatible zsweep;"
+              << " use another --cache file.\n";
+    return EXIT_FAILURE;
+  }
+  std::vector<size_t> pending;
+  size_t skipped = 0;
+  for (size_t i = 0; i < grid.size(); ++i) {
+    auto& v = grid[i];
+    if (not v.rules.playable(v.unplayable)) {
+      skipped++;
+      continue;
+    }
+    v.cached = cache.find(v.rules, eval.hash(), v.stats);
+    if (not v.cached) {
+      pending.push_back(i);
+    }
+  }
+
+  std::cout << grid.size() << " variant(s), " << grid.size() - skipped - pending.size()
+            << " from the cache, " << skipped << " unplayable, " << pending.size()
+            << " to play (" << eval.games
+            << " games each, lineup " << eval.lineup << ", " << threads << " thread(s)).\n";
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> next{ 0 };
+  std::vector<std::thread> pool;
+  for (size_t t = 0; t < std::min(threads, pending.size()); ++t) {
+    pool.emplace_back([&] {
+      for (size_t i; (i = next++) < pending.size();) {
+        auto& v = grid[pending[i]];
+        v.stats = evaluate(v.rules, eval, lineup);
+        if (not cache.store(v.rules, eval.hash(), v.stats)) {
+          std::cerr << "Could not write to the cache \"" << cache_path << "\".\n";
+        }
+      }
+    });
+  }
+  for (auto& th : pool) {
+    th.join();
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "\n";
+  report(axes, grid, lineup.size());
+  std::cout << "\nPlayed " << pending.size() << " variant(s) in " << std::setprecision(1)
+            << seconds << " s.\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+/**
+ * @file ztrain.cpp
+ *
+ * @description
+ * Self-play trainer for the tabular hold policy used by "@policy" bots.
+ *
+ * Every epoch, each thread plays a batch of self-play games with the current
+ * greedy table plus epsilon exploration and collects (cell, action, outcome)
+ * samples. The batches are merged into the action values (every-visit Monte
+ * Carlo: 1 for the winner's decisions, 0 otherwise) and the table is made
+ * greedy again. Periodically the greedy table is evaluated against fixed
+ * threshold baselines, rotating its seat, and the rollout throughput is
+ * reported in environment steps (decisions) per second.
+ *
+ * The table is written in the versioned policy file format (policy.hpp),
+ * which records the rules it was trained for and the estimated win rate of
+ * each cell's action; the game maps it read-only at startup.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread tools/ztrain.cpp -o ztrain
+ * Usage: ./ztrain <config.ini> <out.policy> [--players N] [--threads T]
+ *                 [--epochs E] [--batch B] [--epsilon X] [--eval-every K]
+ *                 [--eval-games G] [--baselines t2,t3] [--seed S]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/policy.hpp"
+
+/// Command-line options.
+struct Options {
+  size_t players{ 2 };
+  size_t threads{ std::max(1u, std::thread::hardware_concurrency()) };
+  size_t epochs{ 200 };
+  size_t batch{ 2000 };
+  double epsilon{ 0.1 };
+  size_t eval_every{ 20 };
+  size_t eval_games{ 20000 };
+  std::string baselines{ "t2,t3" };
+  uint64_t seed{ 2024 };
+};
+
+/// A decision taken during a rollout: (cell * 2 + action, seat).
+struct Step {
+  uint32_t index;
+  uint8_t seat;
+};
+
+/// What one thread collected in one epoch.
+struct Batch {
+  std::vector<std::pair<uint32_t, float>> samples;
+  uint64_t steps{ 0 };
+};
+
+/// Action values of every cell (sum of outcomes and visit count per action).
+class ActionValues {
+public:
+  ActionValues() : sum(PolicyTable::cells * 2), count(PolicyTable::cells * 2) {}
+
+  void add(const Batch& batch) {
+    for (const auto& [index, outcome] : batch.samples) {
+      sum[index] += outcome;
+      count[index]++;
+    }
+  }
+
+  /// Greedy action, or the baseline until both actions have been tried.
+  bool greedy(size_t cell) const {
+    auto roll = 2 * cell, hold = 2 * cell + 1;
+    if (count[roll] == 0 or count[hold] == 0) {
+      return PolicyTable::baseline(cell);
+    }
+    return sum[hold] / count[hold] >= sum[roll] / count[roll];
+  }
+
+  /// Estimated win rate of an action, or -1 if it was never tried.
+  double value(size_t cell, bool hold) const {
+    auto i = 2 * cell + hold;
+    return count[i] == 0 ? -1 : sum[i] / count[i];
+  }
+
+  size_t explored() const {
+    size_t n = 0;
+    for (size_t c = 0; c < PolicyTable::cells; ++c) {
+      n += count[2 * c] != 0 and count[2 * c + 1] != 0;
+    }
+    return n;
+  }
+
+private:
+  std::vector<double> sum;
+  std::vector<uint32_t> count;
+};
+
+/// Plays `games` self-play games starting at game number `first`.
+void rollouts(const GameRules& rules, const PolicyTable& table, const Options& opt,
+              uint64_t first, size_t games, Batch& batch) {
+  Simulator sim(rules);
+  std::vector<Step> trajectory;
+  std::mt19937 explore;
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+  for (size_t g = 0; g < games; ++g) {
+    auto seed = game_seed(opt.seed, first + g);
+    Simulator::seed_rng(explore, ~seed);
+    trajectory.clear();
+
+    sim.start(opt.players, seed);
+    while (not sim.over()) {
+      auto view = sim.view();
+      auto cell = PolicyTable::cell(view);
+      auto hold = coin(explore) < opt.epsilon ? coin(explore) < 0.5 : table.hold(view);
+      trajectory.push_back({ uint32_t(2 * cell + hold), uint8_t(view.seat) });
+      sim.decide(hold);
+    }
+
+    auto winner = sim.result().winner;
+    for (const auto& step : trajectory) {
+      batch.samples.push_back({ step.index, step.seat == winner ? 1.0f : 0.0f });
+    }
+    batch.steps += trajectory.size();
+  }
+}
+
+/// Win rate of the table against the baselines, averaged over every seat.
+double evaluate(const GameRules& rules, std::shared_ptr<const PolicyTable> table,
+                const Options& opt, size_t* turns_played) {
+  std::vector<Policy> baselines;
+  std::stringstream ss(opt.baselines);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    baselines.push_back(make_policy(token));
+  }
+  auto seats = baselines.size() + 1;
+
+  std::vector<uint64_t> wins(opt.threads), turns(opt.threads);
+  std::vector<std::thread> pool;
+  for (size_t t = 0; t < opt.threads; ++t) {
+    pool.emplace_back([&, t] {
+      Simulator sim(rules);
+      for (size_t g = t; g < opt.eval_games; g += opt.threads) {
+        auto seat = g % seats;
+        std::vector<Policy> lineup = baselines;
+        lineup.insert(lineup.begin() + seat, PolicyTable::as_policy(table));
+        // Evaluation games never overlap the training games.
+        auto result = sim.play(lineup, game_seed(~opt.seed, g));
+        wins[t] += result.winner == int(seat);
+        turns[t] += result.turns;
+      }
+    });
+  }
+  for (auto& th : pool) {
+    th.join();
+  }
+
+  uint64_t total = 0;
+  for (size_t t = 0; t < opt.threads; ++t) {
+    total += wins[t];
+    *turns_played += turns[t];
+  }
+  return opt.eval_games == 0 ? 0.0 : double(total) / opt.eval_games;
+}
+
+/// Parses a non-negative integer (no sign, no trailing characters, no overflow).
+bool parse_count(const std::string& text, uint64_t& value) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    value = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+/// Parses a probability (a number from 0 to 1, no trailing characters).
+bool parse_probability(const std::string& text, double& value) {
+  size_t used = 0;
+  try {
+    value = std::stod(text, &used);
+  } catch (const std::logic_error&) {
+    return false;
+  }
+  return used == text.size() and value >= 0 and value <= 1;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini> <out.policy> [--players N]"
+              << " [--threads T] [--epochs E] [--batch B] [--epsilon X] [--eval-every K]"
+              << " [--eval-games G] [--baselines t2,t3] [--seed S]\n";
+    return EXIT_FAILURE;
+  }
+
+  GameRules rules;
+  rules.load(IniParser(argv[1]));
+  std::string error;
+  if (not rules.playable(error) or not PolicyTable::storable(rules, error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  std::string out{ argv[2] };
+  Options opt;
+
+  for (int i = 3; i < argc; i += 2) {
+    std::string flag{ argv[i] };
+    if (i + 1 == argc) {
+      std::cerr << "Option " << flag << " needs a value.\n";
+      return EXIT_FAILURE;
+    }
+    std::string value{ argv[i + 1] };
+    size_t* count = flag == "--players"      ? &opt.players
+                    : flag == "--threads"    ? &opt.threads
+                    : flag == "--epochs"     ? &opt.epochs
+                    : flag == "--batch"      ? &opt.batch
+                    : flag == "--eval-every" ? &opt.eval_every
+                    : flag == "--eval-games" ? &opt.eval_games
+                    : flag == "--seed"       ? &opt.seed
+                                             : nullptr;
+    bool valid = true;
+    if (count != nullptr) {
+      valid = parse_count(value, *count);
+    } else if (flag == "--epsilon") {
+      valid = parse_probability(value, opt.epsilon);
+    } else if (flag == "--baselines") {
+      opt.baselines = value;
+    } else {
+      std::cerr << "Unknown option " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+    if (not valid) {
+      std::cerr << "Invalid value \"" << value << "\" for " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+  }
+  opt.threads = std::max<size_t>(1, opt.threads);
+  if (opt.players < 2 or opt.players > GameResult::max_seats) {
+    std::cerr << "Players must be between 2 and " << GameResult::max_seats << ".\n";
+    return EXIT_FAILURE;
+  }
+  if (opt.eval_every == 0) {
+    std::cerr << "Option --eval-every needs at least 1 epoch.\n";
+    return EXIT_FAILURE;
+  }
+  std::stringstream check(opt.baselines);
+  size_t seats = 1;
+  for (std::string token; std::getline(check, token, ','); ++seats) {
+    if (not make_policy(token)) {
+      std::cerr << "Invalid baseline \"" << token << "\" (use t3 or t3s2).\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (seats < 2 or seats > GameResult::max_seats) {
+    std::cerr << "The evaluation table (the policy and its baselines) needs 2 to "
+              << GameResult::max_seats << " seats.\n";
+    return EXIT_FAILURE;
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto table = std::make_shared<PolicyTable>(rules);
+  ActionValues values;
+  uint64_t game = 0, steps = 0;
+  double rollout_seconds = 0;
+
+  std::cout << std::fixed;
+  for (size_t epoch = 1; epoch <= opt.epochs; ++epoch) {
+    auto begin = clock::now();
+    std::vector<Batch> batches(opt.threads);
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < opt.threads; ++t) {
+      pool.emplace_back(rollouts, std::cref(rules), std::cref(*table), std::cref(opt),
+                        game + t * opt.batch, opt.batch, std::ref(batches[t]));
+    }
+    for (auto& th : pool) {
+      th.join();
+    }
+    rollout_seconds += std::chrono::duration<double>(clock::now() - begin).count();
+    game += opt.threads * opt.batch;
+
+    for (const auto& batch : batches) {
+      values.add(batch);
+      steps += batch.steps;
+    }
+    auto next = std::make_shared<PolicyTable>(rules);
+    for (size_t c = 0; c < PolicyTable::cells; ++c) {
+      auto hold = values.greedy(c);
+      next->set(c, hold, values.value(c, hold));
+    }
+    table = next;
+
+    if (epoch % opt.eval_every == 0 or epoch == opt.epochs) {
+      size_t eval_steps = 0;
+      auto eval_begin = clock::now();
+      auto rate = evaluate(rules, table, opt, &eval_steps);
+      auto eval_seconds = std::chrono::duration<double>(clock::now() - eval_begin).count();
+      std::cout << "epoch " << epoch << ": " << game << " games, " << steps << " steps, "
+                << std::setprecision(0) << steps / rollout_seconds << " steps/s (train), "
+                << eval_steps / eval_seconds << " turns/s (eval), " << values.explored()
+                << " cells explored; win rate vs " << opt.baselines << ": "
+                << std::setprecision(2) << 100 * rate << "% (fair share "
+                << 100.0 / (std::count(opt.baselines.begin(), opt.baselines.end(), ',') + 2)
+                << "%)\n";
+    }
+  }
+
+  if (not table->save(out, error)) {
+    std::cerr << "Could not write \"" << out << "\": " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "Policy written to " << out << ".\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,373 @@
+/**
+ * @file zverify.cpp
+ *
+ * @description
+ * Differential verifier: plays the same seeded bot games on the reference
+ * rules (GameController::update(), run headless) and on a candidate engine
+ * (Simulator), and compares both event streams event by event.
+ *
+ * Along the way it checks two invariants on both engines: every die of the
+ * configuration is in play (dra + bsa + ssa + rolled dice) at each event, and
+ * a player's brains never decrease. Each game draws its own number of players
+ * and threshold policies from its seed, so the run covers tie-breaks, bag
+ * refills and eliminations. Games are spread over forked workers; the first
+ * failing game is shrunk (fewer players, then the smallest failing seed) and
+ * reported with the command that replays it. The games of `regressions`, which
+ * once broke an engine, are verified first.
+ *
+ * Build: g++ -std=c++17 -O2 tools/zverify.cpp src/game_controller.cpp -o zverify
+ * Usage: ./zverify <config.ini> [--games N] [--workers W] [--seed S] [--max-players P]
+ *        ./zverify <config.ini> --replay <seed> --lineup t2,t3
+ */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/game_controller.hpp"
+
+/// Policies the games are drawn from.
+const std::vector<std::string> menu{ "t1", "t2", "t3", "t4", "t5", "t2s2", "t4s2", "t8", "t20" };
+
+/// Games that broke an engine with the default zdice.ini, verified first (seed, lineup).
+const std::vector<std::pair<uint64_t, std::string>> regressions{
+  { 2, "t2,t3,t4" },  // Tie-break that eliminates the last seat (event after PARSING_TIE)
+  { 7, "t2,t3,t4" },  // Game that ends with the tie-break
+};
+
+/// Outcome of one verified game.
+struct Verdict {
+  bool ok{ true };
+  size_t events{ 0 };  ///< Events compared
+  size_t index{ 0 };   ///< First mismatching event
+  std::string reason;
+};
+
+/// Lineup of game `seed`: 2 to `max_players` policies from the menu.
+std::vector<std::string> lineup_for(uint64_t seed, size_t max_players) {
+  auto h = game_seed(seed, 0);
+  std::vector<std::string> lineup(2 + h % (max_players - 1));
+  for (auto& p : lineup) {
+    h = game_seed(h, 1);
+    p = menu[h % menu.size()];
+  }
+  return lineup;
+}
+
+std::string join(const std::vector<std::string>& lineup) {
+  std::string s;
+  for (const auto& p : lineup) {
+    s += (s.empty() ? "" : ",") + p;
+  }
+  return s;
+}
+
+/// Checks the invariants of one engine's stream; returns the reason of the first failure.
+std::string check_invariants(const std::vector<GameEvent>& events, size_t total_dice,
+                             size_t* index) {
+  std::vector<uint32_t> brains(GameResult::max_seats, 0);
+  for (size_t i = 0; i < events.size(); ++i) {
+    const auto& e = events[i];
+    *index = i;
+    if (e.kind == TIE) {
+      // Eliminated players shift the indices of the others.
+      std::fill(brains.begin(), brains.end(), 0);
+      continue;
+    }
+    if (e.kind != ROLL and e.kind != HOLD and e.kind != BUST) {
+      continue;
+    }
+    if (e.dice != total_dice) {
+      return std::to_string(e.dice) + " dice in play, expected " + std::to_string(total_dice);
+    }
+    if (e.value < brains[e.player]) {
+      return "brains decreased from " + std::to_string(brains[e.player]);
+    }
+    brains[e.player] = e.value;
+  }
+  return "";
+}
+
+/// Plays one game on both engines and compares them.
+Verdict verify(const GameRules& rules, Simulator& sim, const std::vector<std::string>& names,
+               uint64_t seed, std::vector<GameEvent>* reference = nullptr,
+               std::vector<GameEvent>* candidate = nullptr) {
+  std::vector<Policy> lineup;
+  for (const auto& n : names) {
+    lineup.push_back(make_policy(n));
+  }
+
+  thread_local std::vector<GameEvent> expected, actual;
+  expected.clear();
+  actual.clear();
+
+  sim.observe([](const GameEvent& e) { actual.push_back(e); });
+  auto result = sim.play(lineup, seed);
+
+  // The controller has no turn limit: stop it where the candidate stopped.
+  GameController::observer = [](const GameEvent& e) { expected.push_back(e); };
+  GameController::reset(rules, lineup, seed);
+  while (not GameController::game_over() and expected.size() <= actual.size()) {
+    GameController::process_events();
+    GameController::update();
+  }
+  if (not result.finished) {
+    expected.resize(std::min(expected.size(), actual.size()));
+  }
+
+  Verdict v;
+  auto n = std::min(expected.size(), actual.size());
+  for (v.index = 0; v.index < n and expected[v.index] == actual[v.index]; ++v.index) {
+  }
+  v.events = n;
+  if (v.index < n or expected.size() != actual.size()) {
+    v.ok = false;
+    v.reason = v.index < n ? "reference \"" + expected[v.index].str() + "\" vs candidate \""
+                               + actual[v.index].str() + "\""
+                           : "streams end at " + std::to_string(expected.size()) + " and "
+                               + std::to_string(actual.size()) + " events";
+  }
+  for (const auto* stream : { &expected, &actual }) {
+    size_t index = 0;
+    auto reason = check_invariants(*stream, rules.total_dice(), &index);
+    if (v.ok and not reason.empty()) {
+      v.ok = false;
+      v.index = index;
+      v.reason = (stream == &expected ? "reference: " : "candidate: ") + reason;
+    }
+  }
+
+  if (reference != nullptr) {
+    *reference = expected;
+  }
+  if (candidate != nullptr) {
+    *candidate = actual;
+  }
+  return v;
+}
+
+/// Parses a non-negative integer (no sign, no trailing characters, no overflow).
+bool parse_count(const std::string& text, uint64_t& value) {
+  if (text.empty() or text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  try {
+    value = std::stoull(text);
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+  return true;
+}
+
+/// Summary sent by each worker through its pipe.
+struct WorkerReport {
+  uint64_t games{ 0 };
+  uint64_t events{ 0 };
+  uint64_t failures{ 0 };
+  uint64_t first_failure{ UINT64_MAX };
+};
+
+WorkerReport run_worker(const GameRules& rules, uint64_t base, uint64_t games, size_t worker,
+                        size_t workers, size_t max_players) {
+  Simulator sim(rules);
+  WorkerReport r;
+  for (uint64_t g = worker; g < games; g += workers) {
+    auto seed = game_seed(base, g);
+    auto v = verify(rules, sim, lineup_for(seed, max_players), seed);
+    r.games++;
+    r.events += v.events;
+    if (not v.ok) {
+      r.failures++;
+      r.first_failure = std::min(r.first_failure, g);
+    }
+  }
+  return r;
+}
+
+/// Reduces a failing game: fewer players first, then the smallest failing seed.
+void shrink(const GameRules& rules, uint64_t base, uint64_t game, size_t max_players) {
+  Simulator sim(rules);
+  auto seed = game_seed(base, game);
+  auto lineup = lineup_for(seed, max_players);
+  auto fails = [&](const std::vector<std::string>& l, uint64_t s) {
+    return not verify(rules, sim, l, s).ok;
+  };
+
+  for (bool progress = true; progress and lineup.size() > 2;) {
+    progress = false;
+    for (size_t i = 0; i < lineup.size() and lineup.size() > 2; ++i) {
+      auto smaller = lineup;
+      smaller.erase(smaller.begin() + i);
+      if (fails(smaller, seed)) {
+        lineup = smaller;
+        progress = true;
+        break;
+      }
+    }
+  }
+  for (uint64_t s = 0; s < 100000 and s < seed; ++s) {
+    if (fails(lineup, s)) {
+      seed = s;
+      break;
+    }
+  }
+
+  auto v = verify(rules, sim, lineup, seed);
+  std::cout << "Smallest reproduction: seed " << seed << ", lineup " << join(lineup)
+            << ", event " << v.index << ": " << v.reason << "\n"
+            << "Replay with: zverify <config.ini> --replay " << seed << " --lineup "
+            << join(lineup) << "\n";
+}
+
+int replay(const GameRules& rules, uint64_t seed, const std::string& spec) {
+  std::vector<std::string> lineup;
+  std::stringstream ss(spec);
+  for (std::string token; std::getline(ss, token, ',');) {
+    if (not make_policy(token)) {
+      std::cerr << "Invalid policy \"" << token << "\".\n";
+      return EXIT_FAILURE;
+    }
+    lineup.push_back(token);
+  }
+  if (lineup.size() < 2 or lineup.size() > GameResult::max_seats) {
+    std::cerr << "The lineup needs 2 to " << GameResult::max_seats << " seats.\n";
+    return EXIT_FAILURE;
+  }
+  Simulator sim(rules);
+  std::vector<GameEvent> reference, candidate;
+  auto v = verify(rules, sim, lineup, seed, &reference, &candidate);
+  for (size_t i = 0; i < std::max(reference.size(), candidate.size()); ++i) {
+    auto r = i < reference.size() ? reference[i].str() : "-";
+    auto c = i < candidate.size() ? candidate[i].str() : "-";
+    std::cout << (r == c ? "  " : "! ") << i << ": " << r;
+    if (r != c) {
+      std::cout << "  |  " << c;
+    }
+    std::cout << "\n";
+  }
+  std::cout << (v.ok ? "OK" : "MISMATCH: " + v.reason) << "\n";
+  return v.ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <config.ini> [--games N] [--workers W] [--seed S]"
+              << " [--max-players P]\n       " << argv[0]
+              << " <config.ini> --replay <seed> --lineup t2,t3\n";
+    return EXIT_FAILURE;
+  }
+
+  GameRules rules;
+  rules.load(IniParser(argv[1]));
+  uint64_t games = 100000, base = 2024;
+  size_t workers = std::max(1u, std::thread::hardware_concurrency()), max_players = 4;
+  uint64_t replay_seed = 0;
+  bool replaying = false;
+  std::string lineup;
+
+  for (int i = 2; i < argc; i += 2) {
+    std::string flag{ argv[i] };
+    if (i + 1 == argc) {
+      std::cerr << "Option " << flag << " needs a value.\n";
+      return EXIT_FAILURE;
+    }
+    std::string value{ argv[i + 1] };
+    uint64_t number = 0;
+    if ((flag == "--games" or flag == "--workers" or flag == "--seed" or flag == "--max-players"
+         or flag == "--replay")
+        and not parse_count(value, number)) {
+      std::cerr << "Invalid value \"" << value << "\" for " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+    if (flag == "--games") {
+      games = number;
+    } else if (flag == "--workers") {
+      workers = std::max<uint64_t>(1, number);
+    } else if (flag == "--seed") {
+      base = number;
+    } else if (flag == "--max-players") {
+      max_players = std::clamp<uint64_t>(number, 2, GameResult::max_seats);
+    } else if (flag == "--replay") {
+      replay_seed = number;
+      replaying = true;
+    } else if (flag == "--lineup") {
+      lineup = value;
+    } else {
+      std::cerr << "Unknown option " << flag << ".\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::string error;
+  if (not rules.playable(error)) {
+    std::cerr << "Unsupported rules: " << error << ".\n";
+    return EXIT_FAILURE;
+  }
+  if (replaying) {
+    return replay(rules, replay_seed, lineup.empty() ? "t2,t3" : lineup);
+  }
+
+  Simulator sim(rules);
+  for (const auto& [seed, spec] : regressions) {
+    std::vector<std::string> names;
+    std::stringstream ss(spec);
+    for (std::string token; std::getline(ss, token, ',');) {
+      names.push_back(token);
+    }
+    auto v = verify(rules, sim, names, seed);
+    if (not v.ok) {
+      std::cout << "Regression game failed at event " << v.index << ": " << v.reason << "\n"
+                << "Replay with: zverify <config.ini> --replay " << seed << " --lineup " << spec
+                << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::pair<pid_t, int>> children;
+  for (size_t w = 0; w < workers; ++w) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      break;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      auto report = run_worker(rules, base, games, w, workers, max_players);
+      auto written = write(fds[1], &report, sizeof(report));
+      _exit(written == sizeof(report) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(fds[1]);
+    children.push_back({ pid, fds[0] });
+  }
+
+  WorkerReport total;
+  for (auto [pid, fd] : children) {
+    WorkerReport r;
+    if (read(fd, &r, sizeof(r)) == sizeof(r)) {
+      total.games += r.games;
+      total.events += r.events;
+      total.failures += r.failures;
+      total.first_failure = std::min(total.first_failure, r.first_failure);
+    }
+    close(fd);
+    waitpid(pid, nullptr, 0);
+  }
+
+  std::cout << total.games << " games, " << total.events << " events compared, "
+            << total.failures << " mismatch(es).\n";
+  if (total.games != games) {
+    std::cout << "Some workers did not report.\n";
+    return EXIT_FAILURE;
+  }
+  if (total.failures != 0) {
+    shrink(rules, base, total.first_failure, max_players);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}